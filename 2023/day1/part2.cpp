@@ -6,12 +6,107 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <fstream>
-#include <regex>
-#include <map>
+#include <array>
+#include <queue>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Aho-Corasick automaton over the digit words. Each state has a transition
+// for every lowercase letter (with the failure links already folded in), and
+// the digit of the longest word that ends in that state, or -1 if none does.
+// Built over the reversed words, it finds the last digit word in a line by
+// scanning it from the end.
+class DigitWordAutomaton {
+private:
+    std::vector<std::array<int, 26>> transitions;
+    std::vector<int> outputs;
+
+public:
+    DigitWordAutomaton(bool reversed) {
+        const std::array<std::string, 10> words = {
+            "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"
+        };
+
+        // Build the trie.
+        transitions.push_back({});
+        transitions[0].fill(-1);
+        outputs.push_back(-1);
+        for (int digit = 0; digit < 10; ++digit) {
+            std::string word = words[digit];
+            if (reversed) {
+                word = std::string(word.rbegin(), word.rend());
+            }
+            int state = 0;
+            for (char c : word) {
+                int letter = c - 'a';
+                if (transitions[state][letter] == -1) {
+                    transitions[state][letter] = transitions.size();
+                    transitions.push_back({});
+                    transitions.back().fill(-1);
+                    outputs.push_back(-1);
+                }
+                state = transitions[state][letter];
+            }
+            outputs[state] = digit;
+        }
+
+        // Breadth first, fill in the missing transitions from each state's
+        // failure state, and inherit its output if the state has none.
+        std::vector<int> failures(transitions.size(), 0);
+        std::queue<int> queue;
+        for (int letter = 0; letter < 26; ++letter) {
+            if (transitions[0][letter] == -1) {
+                transitions[0][letter] = 0;
+            }
+            else {
+                queue.push(transitions[0][letter]);
+            }
+        }
+        while (!queue.empty()) {
+            int state = queue.front();
+            queue.pop();
+            if (outputs[state] == -1) {
+                outputs[state] = outputs[failures[state]];
+            }
+            for (int letter = 0; letter < 26; ++letter) {
+                int child = transitions[state][letter];
+                if (child == -1) {
+                    transitions[state][letter] = transitions[failures[state]][letter];
+                }
+                else {
+                    failures[child] = transitions[failures[state]][letter];
+                    queue.push(child);
+                }
+            }
+        }
+    }
+
+    // Returns the next state and sets digit if a digit word or digit
+    // character ends at c. Any other character resets the automaton.
+    int step(int state, char c, int& digit) const {
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+            return 0;
+        }
+        char lower = c | 0x20;
+        if (lower < 'a' || lower > 'z') {
+            return 0;
+        }
+        state = transitions[state][lower - 'a'];
+        digit = outputs[state];
+        return state;
+    }
+};
 
 int solution(std::string fileName);
-std::vector<std::string> readLines(std::string fileName);
+int findFirstDigit(const char* begin, const char* end);
+int findLastDigit(const char* begin, const char* end);
+
+const DigitWordAutomaton forwardAutomaton(false);
+const DigitWordAutomaton reverseAutomaton(true);
 
 int main() {
     std::cout << std::endl;
@@ -21,57 +116,67 @@ int main() {
 }
 
 int solution(std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
+    int file = open(fileName.c_str(), O_RDONLY);
+    struct stat fileStat;
+    if (file == -1 || fstat(file, &fileStat) == -1) {
+        std::cout << "The file doesn't exist you dummy!" << std::endl;
+        if (file != -1) {
+            close(file);
+        }
+        return 0;
+    }
+    if (fileStat.st_size == 0) {
+        close(file);
+        return 0;
+    }
 
-    std::map<std::string, std::string> wordStrToNumberStr = {
-        {"zero", "0"},
-        {"one", "1"},
-        {"two", "2"},
-        {"three", "3"},
-        {"four", "4"},
-        {"five", "5"},
-        {"six", "6"},
-        {"seven", "7"},
-        {"eight", "8"},
-        {"nine", "9"}
-    };
-    std::regex digitPattern("zero|one|two|three|four|five|six|seven|eight|nine|[0-9]", std::regex::icase);
+    void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED) {
+        std::cout << "The file couldn't be mapped!" << std::endl;
+        return 0;
+    }
 
+    // Walk the mapped file a line at a time without copying anything.
+    const char* data = static_cast<const char*>(mapping);
+    const char* dataEnd = data + fileStat.st_size;
     int counter = 0;
-    for (std::string line : input) {
-        std::string firstDigit;
-        std::string secondDigit;
-        std::string searchString = line;
-        std::smatch matches;
-        while(regex_search(searchString, matches, digitPattern)) {
-            if (firstDigit.empty()) {
-                firstDigit = (matches[0].length() > 1) ? wordStrToNumberStr[matches[0]] : matches[0];
-            }
-            secondDigit = (matches[0].length() > 1) ? wordStrToNumberStr[matches[0]] : matches[0];
-            // Since the numbers might overlap (e.g. twone), change the search
-            // string to everything after the start of the found match.
-            searchString = searchString.substr(matches.position(0) + 1);
+    for (const char* lineBegin = data; lineBegin < dataEnd;) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(lineBegin, '\n', dataEnd - lineBegin));
+        if (lineEnd == nullptr) {
+            lineEnd = dataEnd;
+        }
+        int firstDigit = findFirstDigit(lineBegin, lineEnd);
+        if (firstDigit != -1) {
+            counter += firstDigit * 10 + findLastDigit(lineBegin, lineEnd);
         }
-        counter += stoi(firstDigit + secondDigit);
+        lineBegin = lineEnd + 1;
     }
 
+    munmap(mapping, fileStat.st_size);
     return counter;
 }
 
-std::vector<std::string> readLines(std::string fileName) {
-    std::vector<std::string> lines;
-    std::ifstream inputFile(fileName);
-
-    if (inputFile.fail()) {
-        std::cout << "The file doesn't exist you dummy!" << std::endl;
-    }
-    else {
-        std::string line;
-        while (std::getline(inputFile, line)) {
-            lines.push_back(line);
+int findFirstDigit(const char* begin, const char* end) {
+    int state = 0;
+    for (const char* c = begin; c != end; ++c) {
+        int digit = -1;
+        state = forwardAutomaton.step(state, *c, digit);
+        if (digit != -1) {
+            return digit;
         }
-        inputFile.close();
     }
+    return -1;
+}
 
-    return lines;
+int findLastDigit(const char* begin, const char* end) {
+    int state = 0;
+    for (const char* c = end; c != begin; --c) {
+        int digit = -1;
+        state = reverseAutomaton.step(state, *(c - 1), digit);
+        if (digit != -1) {
+            return digit;
+        }
+    }
+    return -1;
 }
@@ -7,17 +7,37 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <queue>
-#include <algorithm>
-#include <iomanip>
+#include <array>
+#include <bit>
+#include <cstdint>
 
 enum Direction { TOP, RIGHT, BOTTOM, LEFT };
 
-int solution(const std::string fileName);
-char decodeS(const std::vector<std::string>& input, const std::pair<int, int>& startPos);
-std::vector<std::pair<int, int>> getNeighbours(const std::vector<std::string>& input, const std::pair<int, int>& currentPos);
-bool compatible(const char symbol, const Direction direction, const char adjacent);
-void printGrid(const std::vector<std::vector<int>>& grid);
+// The directions each tile's pipe leads in, as a bitmask over Direction.
+// Anything that isn't a pipe, including the start, leads nowhere.
+const std::array<uint8_t, 256> pipeOpenings = []() {
+    std::array<uint8_t, 256> openings = {};
+    openings['|'] = (1 << TOP) | (1 << BOTTOM);
+    openings['-'] = (1 << LEFT) | (1 << RIGHT);
+    openings['L'] = (1 << TOP) | (1 << RIGHT);
+    openings['J'] = (1 << TOP) | (1 << LEFT);
+    openings['7'] = (1 << BOTTOM) | (1 << LEFT);
+    openings['F'] = (1 << BOTTOM) | (1 << RIGHT);
+    return openings;
+}();
+
+const std::array<int, 4> rowSteps = { -1, 0, 1, 0 };
+const std::array<int, 4> colSteps = { 0, 1, 0, -1 };
+
+// The number of tiles in the loop, and twice its signed shoelace area taken
+// through the tile centres.
+struct LoopTrace {
+    long long length;
+    long long doubleArea;
+};
+
+long long solution(const std::string fileName);
+LoopTrace traceLoop(const std::vector<std::string>& input);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
@@ -28,194 +48,70 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(const std::string fileName) {
+long long solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
 
-    std::vector<std::vector<int>> grid(input.size(), std::vector<int>(input[0].length(), -1));
-    std::pair<int, int> startPos;
-    for (int i1 = 0; i1 < input.size(); ++i1) {
-        for (int i2 = 0; i2 < input[i1].length(); ++i2) {
-            if (input[i1][i2] == 'S') {
-                startPos = std::pair<int, int>(i1, i2);
-                input[i1][i2] = decodeS(input, startPos);
-                grid[i1][i2] = 0;
-                goto endLoops;
-            }
-        }
-    }
-    endLoops:
-
-    int maxDistance = 0;
-    std::queue<std::pair<int, int>> queue({startPos});
-    while (!queue.empty()) {
-        std::pair<int, int> currentPos = queue.front();
-        queue.pop();
-        std::vector<std::pair<int, int>> neighbours = getNeighbours(input, currentPos);
-        for (std::pair<int, int> neighbour : neighbours) {
-            if (grid[neighbour.first][neighbour.second] == -1) {
-                queue.push(neighbour);
-                grid[neighbour.first][neighbour.second] = grid[currentPos.first][currentPos.second] + 1;
-                if (grid[neighbour.first][neighbour.second] > maxDistance) {
-                    maxDistance = grid[neighbour.first][neighbour.second];
-                }
-            }
-        }
-    }
-
-    return maxDistance;
-}
-
-char decodeS(const std::vector<std::string>& input, const std::pair<int, int>& startPos) {
-    std::vector<char> allChars = {'|', '-', 'L', 'J', '7', 'F'};
-    std::vector<char> possibleChars;
-    for (char c : allChars) {
-        if (startPos.first > 0) {
-            if (compatible(c, TOP, input[startPos.first - 1][startPos.second])) {
-                possibleChars.push_back(c);
-            }
-        }
-        if (startPos.second < input[startPos.first].length() - 1) {
-            if (compatible(c, RIGHT, input[startPos.first][startPos.second + 1])) {
-                possibleChars.push_back(c);
-            }
-        }
-        if (startPos.first < input.size() - 1) {
-            if (compatible(c, BOTTOM, input[startPos.first + 1][startPos.second])) {
-                possibleChars.push_back(c);
-            }
-        }
-        if (startPos.second > 0) {
-            if (compatible(c, LEFT, input[startPos.first][startPos.second - 1])) {
-                possibleChars.push_back(c);
-            }
-        }
-    }
-
-    std::sort(possibleChars.begin(), possibleChars.end());
-    for (int i = 0; i < possibleChars.size() - 1; ++i) {
-        if (possibleChars[i] == possibleChars[i+1]) {
-            return possibleChars[i];
-        }
-    }
+    // The farthest point is halfway round the loop.
+    return traceLoop(input).length / 2;
 }
 
-std::vector<std::pair<int, int>> getNeighbours(const std::vector<std::string>& input, const std::pair<int, int>& currentPos) {
-    std::vector<std::pair<int, int>> neighbours;
+LoopTrace traceLoop(const std::vector<std::string>& input) {
+    LoopTrace trace = { 0, 0 };
 
-    char symbol = input[currentPos.first][currentPos.second];
-
-    if (currentPos.first > 0) {
-        if (compatible(symbol, TOP, input[currentPos.first - 1][currentPos.second])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first - 1, currentPos.second));
+    long long startRow = -1;
+    long long startCol = -1;
+    for (size_t row = 0; row < input.size() && startRow == -1; ++row) {
+        size_t col = input[row].find('S');
+        if (col != std::string::npos) {
+            startRow = row;
+            startCol = col;
         }
     }
-    if (currentPos.second < input[currentPos.first].length() - 1) {
-        if (compatible(symbol, RIGHT, input[currentPos.first][currentPos.second + 1])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first, currentPos.second + 1));
-        }
+    if (startRow == -1) {
+        return trace;
     }
-    if (currentPos.first < input.size() - 1) {
-        if (compatible(symbol, BOTTOM, input[currentPos.first + 1][currentPos.second])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first + 1, currentPos.second));
+
+    auto getTile = [&](long long row, long long col) {
+        if (row < 0 || row >= static_cast<long long>(input.size()) || col < 0 || col >= static_cast<long long>(input[row].length())) {
+            return '.';
         }
-    }
-    if (currentPos.second > 0) {
-        if (compatible(symbol, LEFT, input[currentPos.first][currentPos.second - 1])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first, currentPos.second - 1));
+        return input[row][col];
+    };
+
+    // Leave the start through the first neighbour whose pipe leads back in.
+    int direction = -1;
+    for (int candidate = TOP; candidate <= LEFT && direction == -1; ++candidate) {
+        char neighbour = getTile(startRow + rowSteps[candidate], startCol + colSteps[candidate]);
+        if (pipeOpenings[static_cast<unsigned char>(neighbour)] & (1 << ((candidate + 2) % 4))) {
+            direction = candidate;
         }
     }
-
-    return neighbours;
-}
-
-bool compatible(const char symbol, const Direction direction, const char adjacent) {
-    switch (symbol) {
-        case '|':
-            switch (direction) {
-                case TOP:
-                    return adjacent == '|' || adjacent == '7' || adjacent == 'F';
-                case RIGHT:
-                    return false;
-                case BOTTOM:
-                    return adjacent == '|' || adjacent == 'J' || adjacent == 'L';
-                case LEFT:
-                    return false;
-            }
-        case '-':
-            switch (direction) {
-                case TOP:
-                    return false;
-                case RIGHT:
-                    return adjacent == '-' || adjacent == 'J' || adjacent == '7';
-                case BOTTOM:
-                    return false;
-                case LEFT:
-                    return adjacent == '-' || adjacent == 'L' || adjacent == 'F';
-            }
-        case 'L':
-            switch (direction) {
-                case TOP:
-                    return adjacent == '|' || adjacent == '7' || adjacent == 'F';
-                case RIGHT:
-                    return adjacent == '-' || adjacent == 'J' || adjacent == '7';
-                case BOTTOM:
-                    return false;
-                case LEFT:
-                    return false;
-            }
-        case 'J':
-            switch (direction) {
-                case TOP:
-                    return adjacent == '|' || adjacent == '7' || adjacent == 'F';
-                case RIGHT:
-                    return false;
-                case BOTTOM:
-                    return false;
-                case LEFT:
-                    return adjacent == '-' || adjacent == 'L' || adjacent == 'F';
-            }
-        case '7':
-            switch (direction) {
-                case TOP:
-                    return false;
-                case RIGHT:
-                    return false;
-                case BOTTOM:
-                    return adjacent == '|' || adjacent == 'J' || adjacent == 'L';
-                case LEFT:
-                    return adjacent == '-' || adjacent == 'L' || adjacent == 'F';
-            }
-        case 'F':
-            switch (direction) {
-                case TOP:
-                    return false;
-                case RIGHT:
-                    return adjacent == '-' || adjacent == 'J' || adjacent == '7';
-                case BOTTOM:
-                    return adjacent == '|' || adjacent == 'J' || adjacent == 'L';
-                case LEFT:
-                    return false;
-            }
+    if (direction == -1) {
+        return trace;
     }
-}
 
-void printGrid(const std::vector<std::vector<int>>& grid) {
-    int maxDigits = 0;
-    for (std::vector<int> row : grid) {
-        for (int num : row) {
-            int digits = std::to_string(num).length();
-            maxDigits = std::max(maxDigits, digits);
+    // Follow the pipes round until we're back at the start. Each pipe only
+    // has one way out besides the way we came in.
+    long long row = startRow;
+    long long col = startCol;
+    do {
+        long long nextRow = row + rowSteps[direction];
+        long long nextCol = col + colSteps[direction];
+        trace.doubleArea += col * nextRow - nextCol * row;
+        ++trace.length;
+        row = nextRow;
+        col = nextCol;
+
+        int cameFrom = 1 << ((direction + 2) % 4);
+        int openings = pipeOpenings[static_cast<unsigned char>(getTile(row, col))];
+        if ((row != startRow || col != startCol) && ((openings & cameFrom) == 0 || (openings & ~cameFrom) == 0)) {
+            std::cout << "The loop is broken!" << std::endl;
+            return { 0, 0 };
         }
-    }
+        direction = std::countr_zero(static_cast<unsigned>(openings & ~cameFrom));
+    } while (row != startRow || col != startCol);
 
-    std::cout << "" << std::endl;
-    for (std::vector<int> row : grid) {
-        for (int num : row) {
-            std::cout << std::setw(maxDigits + 1) << num;
-        }
-        std::cout << "" << std::endl;;
-    }
-    std::cout << "" << std::endl;;
+    return trace;
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
@@ -7,377 +7,119 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <queue>
-#include <algorithm>
-#include <iomanip>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
 
 enum Direction { TOP, RIGHT, BOTTOM, LEFT };
 
-int solution1(const std::string fileName);
-std::vector<std::vector<char>> expandGrid(const std::vector<std::vector<char>>& inputGrid);
-std::vector<std::vector<char>> contractGrid(const std::vector<std::vector<char>>& expandedGrid);
-
-int solution2(const std::string fileName);
-
-char decodeS(const std::vector<std::vector<char>>& inputGrid, const std::pair<int, int>& startPos);
-std::vector<std::pair<int, int>> getNeighbours(const std::vector<std::vector<char>>& grid, const std::pair<int, int>& currentPos);
-bool compatible(const char symbol, const Direction direction, const char adjacent);
-void printCharGrid(const std::vector<std::vector<char>>& grid);
-void printNumberGrid(const std::vector<std::vector<int>>& grid);
+// The directions each tile's pipe leads in, as a bitmask over Direction.
+// Anything that isn't a pipe, including the start, leads nowhere.
+const std::array<uint8_t, 256> pipeOpenings = []() {
+    std::array<uint8_t, 256> openings = {};
+    openings['|'] = (1 << TOP) | (1 << BOTTOM);
+    openings['-'] = (1 << LEFT) | (1 << RIGHT);
+    openings['L'] = (1 << TOP) | (1 << RIGHT);
+    openings['J'] = (1 << TOP) | (1 << LEFT);
+    openings['7'] = (1 << BOTTOM) | (1 << LEFT);
+    openings['F'] = (1 << BOTTOM) | (1 << RIGHT);
+    return openings;
+}();
+
+const std::array<int, 4> rowSteps = { -1, 0, 1, 0 };
+const std::array<int, 4> colSteps = { 0, 1, 0, -1 };
+
+// The number of tiles in the loop, and twice its signed shoelace area taken
+// through the tile centres.
+struct LoopTrace {
+    long long length;
+    long long doubleArea;
+};
+
+long long solution(const std::string fileName);
+LoopTrace traceLoop(const std::vector<std::string>& input);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
     std::cout << std::endl;
-    std::cout << "Example 1 Solution 1: " << solution1("part2_example_1.txt") << " (expected 4)" << std::endl;
-    std::cout << "Example 2 Solution 1: " << solution1("part2_example_2.txt") << " (expected 4)" << std::endl;
-    std::cout << "Example 3 Solution 1: " << solution1("part2_example_3.txt") << " (expected 8)" << std::endl;
-    std::cout << "Example 4 Solution 1: " << solution1("part2_example_4.txt") << " (expected 10)" << std::endl;
-    std::cout << "Input Solution 1: " << solution1("input.txt") << std::endl;
-    std::cout << "" << std::endl;
-    std::cout << "Example 1 Solution 2: " << solution2("part2_example_1.txt") << " (expected 4)" << std::endl;
-    std::cout << "Example 2 Solution 2: " << solution2("part2_example_2.txt") << " (expected 4)" << std::endl;
-    std::cout << "Example 3 Solution 2: " << solution2("part2_example_3.txt") << " (expected 8)" << std::endl;
-    std::cout << "Example 4 Solution 2: " << solution2("part2_example_4.txt") << " (expected 10)" << std::endl;
-    std::cout << "Input Solution 2: " << solution2("input.txt") << std::endl;
+    std::cout << "Example 1 Solution: " << solution("part2_example_1.txt") << " (expected 4)" << std::endl;
+    std::cout << "Example 2 Solution: " << solution("part2_example_2.txt") << " (expected 4)" << std::endl;
+    std::cout << "Example 3 Solution: " << solution("part2_example_3.txt") << " (expected 8)" << std::endl;
+    std::cout << "Example 4 Solution: " << solution("part2_example_4.txt") << " (expected 10)" << std::endl;
+    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
     std::cout << std::endl;
 }
 
-int solution1(const std::string fileName) {
+long long solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
-
-    std::vector<std::vector<char>> inputGrid(input.size(), std::vector<char>(input[0].length()));
-    std::vector<std::vector<int>> cycleGrid(input.size(), std::vector<int>(input[0].length(), -1));
-    std::pair<int, int> startPos;
-    for (int i1 = 0; i1 < input.size(); ++i1) {
-        for (int i2 = 0; i2 < input[i1].length(); ++i2) {
-            inputGrid[i1][i2] = input[i1][i2];
-            if (input[i1][i2] == 'S') {
-                startPos = std::pair<int, int>(i1, i2);
-            }
-        }
-    }
-    inputGrid[startPos.first][startPos.second] = decodeS(inputGrid, startPos);
-    cycleGrid[startPos.first][startPos.second] = 0;
-
-    std::queue<std::pair<int, int>> cycleQueue({startPos});
-    while (!cycleQueue.empty()) {
-        std::pair<int, int> currentPos = cycleQueue.front();
-        cycleQueue.pop();
-        std::vector<std::pair<int, int>> neighbours = getNeighbours(inputGrid, currentPos);
-        for (std::pair<int, int> neighbour : neighbours) {
-            if (cycleGrid[neighbour.first][neighbour.second] == -1) {
-                cycleQueue.push(neighbour);
-                cycleGrid[neighbour.first][neighbour.second] = cycleGrid[currentPos.first][currentPos.second] + 1;
-            }
-        }
-    }
-
-    for (int i1 = 0; i1 < inputGrid.size(); ++i1) {
-        for (int i2 = 0; i2 < inputGrid[i1].size(); ++i2) {
-            if (cycleGrid[i1][i2] == -1) {
-                inputGrid[i1][i2] = '.';
-            }
-        }
-    }
-
-    std::vector<std::vector<char>> expandedGrid = expandGrid(inputGrid);
-
-    std::queue<std::pair<int, int>> areaQueue({std::pair<int, int>(0, 0)});
-    while (!areaQueue.empty()) {
-        std::pair<int, int> currentPos = areaQueue.front();
-        areaQueue.pop();
-        std::vector<std::pair<int, int>> neighbours = getNeighbours(expandedGrid, currentPos);
-        for (std::pair<int, int> neighbour : neighbours) {
-            if (expandedGrid[neighbour.first][neighbour.second] == '.') {
-                areaQueue.push(neighbour);
-                expandedGrid[neighbour.first][neighbour.second] = 'O';
-            }
-        }
-    }
-
-    std::vector<std::vector<char>> contractedGrid = contractGrid(expandedGrid);
-
-    int counter = 0;
-    for (int i1 = 0; i1 < contractedGrid.size(); ++i1) {
-        for (int i2 = 0; i2 < contractedGrid[i1].size(); ++i2) {
-            if (contractedGrid[i1][i2] == '.') {
-                ++counter;
-            }
-        }
-    }
-
-    return counter;
-}
-
-std::vector<std::vector<char>> expandGrid(const std::vector<std::vector<char>>& inputGrid) {
-    std::vector<std::vector<char>> expandedGrid((inputGrid.size() * 2) + 1, std::vector<char>((inputGrid[0].size() * 2) + 1));
-
-    for (int i1 = 0; i1 < expandedGrid.size(); ++i1) {
-        for (int i2 = 0; i2 < expandedGrid[i1].size(); ++i2) {
-            if (i1 % 2 == 0) {
-                if (i1 > 0 && (expandedGrid[i1 - 1][i2] == '|' ||  expandedGrid[i1 - 1][i2] == '7' || expandedGrid[i1 - 1][i2] == 'F')){
-                    expandedGrid[i1][i2] = '|';
-                }
-                else {
-                    expandedGrid[i1][i2] = '.';
-                }
-            }
-            else {
-                if (i2 % 2 == 0) {
-                    if (i2 > 0 && (expandedGrid[i1][i2 - 1] == '-' ||  expandedGrid[i1][i2 - 1] == 'L' || expandedGrid[i1][i2 - 1] == 'F')){
-                        expandedGrid[i1][i2] = '-';
-                    }
-                    else {
-                        expandedGrid[i1][i2] = '.';
-                    }
-                }
-                else {
-                    expandedGrid[i1][i2] = inputGrid[(i1 - 1) / 2][(i2 - 1) / 2];
-                }
-            }
-        }
+    LoopTrace trace = traceLoop(input);
+    if (trace.length == 0) {
+        return 0;
     }
 
-    return expandedGrid;
+    // Pick's theorem: area = inside + boundary / 2 - 1, with the loop's tiles
+    // as the boundary points.
+    return (std::abs(trace.doubleArea) - trace.length) / 2 + 1;
 }
 
-std::vector<std::vector<char>> contractGrid(const std::vector<std::vector<char>>& expandedGrid) {
-    std::vector<std::vector<char>> contractedGrid((expandedGrid.size() - 1) / 2, std::vector<char>((expandedGrid[0].size() - 1) / 2));
-
-    for (int i1 = 0; i1 < expandedGrid.size(); ++i1) {
-        for (int i2 = 0; i2 < expandedGrid[i1].size(); ++i2) {
-            if (i1 % 2 != 0 && i2 % 2 != 0) {
-                contractedGrid[(i1 - 1) / 2][(i2 - 1) / 2] = expandedGrid[i1][i2];
-            }
-        }
-    }
-
-    return contractedGrid;
-}
-
-int solution2(const std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
-
-    std::vector<std::vector<char>> inputGrid(input.size(), std::vector<char>(input[0].length()));
-    std::vector<std::vector<int>> cycleGrid(input.size(), std::vector<int>(input[0].length(), -1));
-    std::pair<int, int> startPos;
-    for (int i1 = 0; i1 < input.size(); ++i1) {
-        for (int i2 = 0; i2 < input[i1].length(); ++i2) {
-            inputGrid[i1][i2] = input[i1][i2];
-            if (input[i1][i2] == 'S') {
-                startPos = std::pair<int, int>(i1, i2);
-            }
-        }
-    }
-    inputGrid[startPos.first][startPos.second] = decodeS(inputGrid, startPos);
-    cycleGrid[startPos.first][startPos.second] = 0;
-
-    std::queue<std::pair<int, int>> cycleQueue({startPos});
-    while (!cycleQueue.empty()) {
-        std::pair<int, int> currentPos = cycleQueue.front();
-        cycleQueue.pop();
-        std::vector<std::pair<int, int>> neighbours = getNeighbours(inputGrid, currentPos);
-        for (std::pair<int, int> neighbour : neighbours) {
-            if (cycleGrid[neighbour.first][neighbour.second] == -1) {
-                cycleQueue.push(neighbour);
-                cycleGrid[neighbour.first][neighbour.second] = cycleGrid[currentPos.first][currentPos.second] + 1;
-            }
-        }
-    }
+LoopTrace traceLoop(const std::vector<std::string>& input) {
+    LoopTrace trace = { 0, 0 };
 
-    int counter = 0;
-    for (int i1 = 0; i1 < inputGrid.size(); ++i1) {
-        bool outside = true;
-        char horizontalStart;
-        for (int i2 = 0; i2 < inputGrid[i1].size(); ++i2) {
-            if (cycleGrid[i1][i2] == -1) {
-                inputGrid[i1][i2] = outside ? 'O' : 'I';
-                counter += outside ? 0 : 1;
-            }
-            else {
-                if (inputGrid[i1][i2] == '|') {
-                    outside = !outside;
-                }
-                else if (inputGrid[i1][i2] == 'F' || inputGrid[i1][i2] == 'L') {
-                    horizontalStart = inputGrid[i1][i2];
-                }
-                else if (inputGrid[i1][i2] == 'J' && horizontalStart == 'F') {
-                    outside = !outside;
-                }
-                else if (inputGrid[i1][i2] == '7' && horizontalStart == 'L') {
-                    outside = !outside;
-                }
-            }
+    long long startRow = -1;
+    long long startCol = -1;
+    for (size_t row = 0; row < input.size() && startRow == -1; ++row) {
+        size_t col = input[row].find('S');
+        if (col != std::string::npos) {
+            startRow = row;
+            startCol = col;
         }
     }
-
-    return counter;
-}
-
-char decodeS(const std::vector<std::vector<char>>& inputGrid, const std::pair<int, int>& startPos) {
-    std::vector<char> allChars = {'|', '-', 'L', 'J', '7', 'F'};
-    std::vector<char> possibleChars;
-    for (char c : allChars) {
-        if (startPos.first > 0) {
-            if (compatible(c, TOP, inputGrid[startPos.first - 1][startPos.second])) {
-                possibleChars.push_back(c);
-            }
-        }
-        if (startPos.second < inputGrid[startPos.first].size() - 1) {
-            if (compatible(c, RIGHT, inputGrid[startPos.first][startPos.second + 1])) {
-                possibleChars.push_back(c);
-            }
-        }
-        if (startPos.first < inputGrid.size() - 1) {
-            if (compatible(c, BOTTOM, inputGrid[startPos.first + 1][startPos.second])) {
-                possibleChars.push_back(c);
-            }
-        }
-        if (startPos.second > 0) {
-            if (compatible(c, LEFT, inputGrid[startPos.first][startPos.second - 1])) {
-                possibleChars.push_back(c);
-            }
-        }
+    if (startRow == -1) {
+        return trace;
     }
 
-    std::sort(possibleChars.begin(), possibleChars.end());
-    for (int i = 0; i < possibleChars.size() - 1; ++i) {
-        if (possibleChars[i] == possibleChars[i+1]) {
-            return possibleChars[i];
+    auto getTile = [&](long long row, long long col) {
+        if (row < 0 || row >= static_cast<long long>(input.size()) || col < 0 || col >= static_cast<long long>(input[row].length())) {
+            return '.';
         }
-    }
-}
-
-std::vector<std::pair<int, int>> getNeighbours(const std::vector<std::vector<char>>& grid, const std::pair<int, int>& currentPos) {
-    std::vector<std::pair<int, int>> neighbours;
-
-    char symbol = grid[currentPos.first][currentPos.second];
+        return input[row][col];
+    };
 
-    if (currentPos.first > 0) {
-        if (compatible(symbol, TOP, grid[currentPos.first - 1][currentPos.second])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first - 1, currentPos.second));
+    // Leave the start through the first neighbour whose pipe leads back in.
+    int direction = -1;
+    for (int candidate = TOP; candidate <= LEFT && direction == -1; ++candidate) {
+        char neighbour = getTile(startRow + rowSteps[candidate], startCol + colSteps[candidate]);
+        if (pipeOpenings[static_cast<unsigned char>(neighbour)] & (1 << ((candidate + 2) % 4))) {
+            direction = candidate;
         }
     }
-    if (currentPos.second < grid[currentPos.first].size() - 1) {
-        if (compatible(symbol, RIGHT, grid[currentPos.first][currentPos.second + 1])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first, currentPos.second + 1));
-        }
-    }
-    if (currentPos.first < grid.size() - 1) {
-        if (compatible(symbol, BOTTOM, grid[currentPos.first + 1][currentPos.second])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first + 1, currentPos.second));
-        }
-    }
-    if (currentPos.second > 0) {
-        if (compatible(symbol, LEFT, grid[currentPos.first][currentPos.second - 1])) {
-            neighbours.push_back(std::pair<int, int>(currentPos.first, currentPos.second - 1));
-        }
-    }
-
-    return neighbours;
-}
-
-bool compatible(const char symbol, const Direction direction, const char adjacent) {
-    switch (symbol) {
-        case '|':
-            switch (direction) {
-                case TOP:
-                    return adjacent == '|' || adjacent == '7' || adjacent == 'F';
-                case RIGHT:
-                    return false;
-                case BOTTOM:
-                    return adjacent == '|' || adjacent == 'J' || adjacent == 'L';
-                case LEFT:
-                    return false;
-            }
-        case '-':
-            switch (direction) {
-                case TOP:
-                    return false;
-                case RIGHT:
-                    return adjacent == '-' || adjacent == 'J' || adjacent == '7';
-                case BOTTOM:
-                    return false;
-                case LEFT:
-                    return adjacent == '-' || adjacent == 'L' || adjacent == 'F';
-            }
-        case 'L':
-            switch (direction) {
-                case TOP:
-                    return adjacent == '|' || adjacent == '7' || adjacent == 'F';
-                case RIGHT:
-                    return adjacent == '-' || adjacent == 'J' || adjacent == '7';
-                case BOTTOM:
-                    return false;
-                case LEFT:
-                    return false;
-            }
-        case 'J':
-            switch (direction) {
-                case TOP:
-                    return adjacent == '|' || adjacent == '7' || adjacent == 'F';
-                case RIGHT:
-                    return false;
-                case BOTTOM:
-                    return false;
-                case LEFT:
-                    return adjacent == '-' || adjacent == 'L' || adjacent == 'F';
-            }
-        case '7':
-            switch (direction) {
-                case TOP:
-                    return false;
-                case RIGHT:
-                    return false;
-                case BOTTOM:
-                    return adjacent == '|' || adjacent == 'J' || adjacent == 'L';
-                case LEFT:
-                    return adjacent == '-' || adjacent == 'L' || adjacent == 'F';
-            }
-        case 'F':
-            switch (direction) {
-                case TOP:
-                    return false;
-                case RIGHT:
-                    return adjacent == '-' || adjacent == 'J' || adjacent == '7';
-                case BOTTOM:
-                    return adjacent == '|' || adjacent == 'J' || adjacent == 'L';
-                case LEFT:
-                    return false;
-            }
-        case '.':
-            return (adjacent == '.');
+    if (direction == -1) {
+        return trace;
     }
-}
 
-void printCharGrid(const std::vector<std::vector<char>>& grid) {
-    std::cout << "" << std::endl;
-    for (int i1 = 0; i1 < grid.size(); ++i1) {
-        for (int i2 = 0; i2 < grid[i1].size(); ++i2) {
-            std::cout << grid[i1][i2];
-        }
-        std::cout << "" << std::endl;
-    }
-    std::cout << "" << std::endl;
-}
+    // Follow the pipes round until we're back at the start. Each pipe only
+    // has one way out besides the way we came in.
+    long long row = startRow;
+    long long col = startCol;
+    do {
+        long long nextRow = row + rowSteps[direction];
+        long long nextCol = col + colSteps[direction];
+        trace.doubleArea += col * nextRow - nextCol * row;
+        ++trace.length;
+        row = nextRow;
+        col = nextCol;
 
-void printNumberGrid(const std::vector<std::vector<int>>& grid) {
-    int maxDigits = 0;
-    for (std::vector<int> row : grid) {
-        for (int num : row) {
-            int digits = std::to_string(num).length();
-            maxDigits = std::max(maxDigits, digits);
+        int cameFrom = 1 << ((direction + 2) % 4);
+        int openings = pipeOpenings[static_cast<unsigned char>(getTile(row, col))];
+        if ((row != startRow || col != startCol) && ((openings & cameFrom) == 0 || (openings & ~cameFrom) == 0)) {
+            std::cout << "The loop is broken!" << std::endl;
+            return { 0, 0 };
         }
-    }
+        direction = std::countr_zero(static_cast<unsigned>(openings & ~cameFrom));
+    } while (row != startRow || col != startCol);
 
-    std::cout << "" << std::endl;
-    for (std::vector<int> row : grid) {
-        for (int num : row) {
-            std::cout << std::setw(maxDigits + 1) << num;
-        }
-        std::cout << "" << std::endl;;
-    }
-    std::cout << "" << std::endl;;
+    return trace;
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
@@ -7,84 +7,80 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <cstdlib>
 
-int solution(const std::string fileName);
-std::vector<std::string> readLines(const std::string fileName);
+// Every path between two galaxies crosses some rows and columns that had a
+// galaxy in them and some that were empty, and only the empty ones expand.
+// Summing the two kinds of crossing separately over all pairs means any
+// expansion multiplier can be answered from the same totals.
+struct DistanceSum {
+    long long occupiedCrossings;
+    long long emptyCrossings;
+
+    long long getTotal(long long multiplier) const {
+        return occupiedCrossings + multiplier * emptyCrossings;
+    }
+};
+
+DistanceSum measureGalaxies(const std::string fileName);
+void addAxisCrossings(const std::vector<long long>& galaxyCounts, DistanceSum& sum);
 
 int main() {
     std::cout << std::endl;
-    std::cout << "Example Solution: " << solution("example.txt") << " (expected 374)" << std::endl;
-    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
+    std::cout << "Example Solution: " << measureGalaxies("example.txt").getTotal(2) << " (expected 374)" << std::endl;
+    std::cout << "Input Solution: " << measureGalaxies("input.txt").getTotal(2) << std::endl;
     std::cout << std::endl;
 }
 
-int solution(const std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
-    int originalRowCount = input.size();
-    int originalColCount = input[0].length();
-
-    std::vector<bool> rowIsEmpty(originalRowCount, true);
-    std::vector<bool> colIsEmpty(originalColCount, true);
-    for (int i1 = 0; i1 < originalRowCount; ++i1) {
-        for (int i2 = 0; i2 < originalColCount; ++i2) {
-            if (input[i1][i2] != '.') {
-                rowIsEmpty[i1] = false;
-                colIsEmpty[i2] = false;
-            }
-        }
-    }
-
-    for (int i1 = originalRowCount - 1; i1 >= 0; --i1) {
-        if (rowIsEmpty[i1]) {
-            input.insert(input.begin() + i1 + 1, std::string(originalRowCount, '.'));
-        }
+DistanceSum measureGalaxies(const std::string fileName) {
+    DistanceSum sum = { 0, 0 };
+    std::ifstream inputFile(fileName);
+    if (inputFile.fail()) {
+        std::cout << "The file doesn't exist you dummy!" << std::endl;
+        return sum;
     }
-    int newRowCount = input.size();
 
-    for (int i2 = originalColCount - 1; i2 >= 0; --i2) {
-        if (colIsEmpty[i2]) {
-            for (int i1 = 0; i1 < newRowCount; ++i1) {
-                input[i1].insert(i2 + 1, ".");
-            }
+    // All that matters is how many galaxies are in each row and column.
+    std::vector<long long> rowGalaxyCounts;
+    std::vector<long long> colGalaxyCounts;
+    std::string line;
+    while (std::getline(inputFile, line)) {
+        if (colGalaxyCounts.size() < line.length()) {
+            colGalaxyCounts.resize(line.length(), 0);
         }
-    }
-    int newColCount = input[0].length();
-
-    std::vector<std::pair<int, int>> galaxyPositions;
-    for (int i1 = 0; i1 < newRowCount; ++i1) {
-        for (int i2 = 0; i2 < newColCount; ++i2) {
-            if (input[i1][i2] != '.') {
-                galaxyPositions.push_back(std::pair<int, int>(i1, i2));
+        long long rowGalaxyCount = 0;
+        for (size_t col = 0; col < line.length(); ++col) {
+            if (line[col] != '.') {
+                ++rowGalaxyCount;
+                ++colGalaxyCounts[col];
             }
         }
+        rowGalaxyCounts.push_back(rowGalaxyCount);
     }
 
-    int sum = 0;
-    for (int i1 = 0; i1 < galaxyPositions.size(); ++i1) {
-        for (int i2 = i1 + 1; i2 < galaxyPositions.size(); ++i2) {
-            int distance = std::abs(galaxyPositions[i2].first - galaxyPositions[i1].first) + std::abs(galaxyPositions[i2].second - galaxyPositions[i1].second);
-            sum += distance;
-        }
-    }
-
+    addAxisCrossings(rowGalaxyCounts, sum);
+    addAxisCrossings(colGalaxyCounts, sum);
     return sum;
 }
 
-std::vector<std::string> readLines(const std::string fileName) {
-    std::vector<std::string> lines;
-    std::ifstream inputFile(fileName);
-
-    if (inputFile.fail()) {
-        std::cout << "The file doesn't exist you dummy!" << std::endl;
-    }
-    else {
-        std::string line;
-        while (std::getline(inputFile, line)) {
-            lines.push_back(line);
+// Sweeps the lines of one axis in order. Counting occupied and empty lines
+// separately, each galaxy's distance to every galaxy before it is its own
+// position times how many came before, less the sum of their positions.
+void addAxisCrossings(const std::vector<long long>& galaxyCounts, DistanceSum& sum) {
+    long long galaxiesSeen = 0;
+    long long occupiedLinesSeen = 0;
+    long long emptyLinesSeen = 0;
+    long long occupiedPositionSum = 0;
+    long long emptyPositionSum = 0;
+    for (long long count : galaxyCounts) {
+        if (count == 0) {
+            ++emptyLinesSeen;
+            continue;
         }
-        inputFile.close();
+        sum.occupiedCrossings += count * (galaxiesSeen * occupiedLinesSeen - occupiedPositionSum);
+        sum.emptyCrossings += count * (galaxiesSeen * emptyLinesSeen - emptyPositionSum);
+        galaxiesSeen += count;
+        occupiedPositionSum += count * occupiedLinesSeen;
+        emptyPositionSum += count * emptyLinesSeen;
+        ++occupiedLinesSeen;
     }
-
-    return lines;
 }
@@ -7,91 +7,85 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <cstdlib>
 
-long long solution(const std::string fileName, int multiplier);
-std::vector<std::string> readLines(const std::string fileName);
+// Every path between two galaxies crosses some rows and columns that had a
+// galaxy in them and some that were empty, and only the empty ones expand.
+// Summing the two kinds of crossing separately over all pairs means any
+// expansion multiplier can be answered from the same totals.
+struct DistanceSum {
+    long long occupiedCrossings;
+    long long emptyCrossings;
+
+    long long getTotal(long long multiplier) const {
+        return occupiedCrossings + multiplier * emptyCrossings;
+    }
+};
+
+DistanceSum measureGalaxies(const std::string fileName);
+void addAxisCrossings(const std::vector<long long>& galaxyCounts, DistanceSum& sum);
 
 int main() {
+    DistanceSum example = measureGalaxies("example.txt");
+    DistanceSum input = measureGalaxies("input.txt");
+
     std::cout << std::endl;
-    std::cout << "Example Solution (multiplier=2): " << solution("example.txt", 2) << " (expected 374)" << std::endl;
-    std::cout << "Example Solution (multiplier=10): " << solution("example.txt", 10) << " (expected 1030)" << std::endl;
-    std::cout << "Example Solution (multiplier=100): " << solution("example.txt", 100) << " (expected 8410)" << std::endl;
-    std::cout << "Input Solution (multiplier=1000000): " << solution("input.txt", 1000000) << std::endl;
+    std::cout << "Example Solution (multiplier=2): " << example.getTotal(2) << " (expected 374)" << std::endl;
+    std::cout << "Example Solution (multiplier=10): " << example.getTotal(10) << " (expected 1030)" << std::endl;
+    std::cout << "Example Solution (multiplier=100): " << example.getTotal(100) << " (expected 8410)" << std::endl;
+    std::cout << "Input Solution (multiplier=1000000): " << input.getTotal(1000000) << std::endl;
     std::cout << std::endl;
 }
 
-long long solution(const std::string fileName, int multiplier) {
-    std::vector<std::string> input = readLines(fileName);
-
-    std::vector<bool> rowIsEmpty(input.size(), true);
-    std::vector<bool> colIsEmpty(input[0].length(), true);
-    for (int i1 = 0; i1 < input.size(); ++i1) {
-        for (int i2 = 0; i2 < input[0].length(); ++i2) {
-            if (input[i1][i2] != '.') {
-                rowIsEmpty[i1] = false;
-                colIsEmpty[i2] = false;
-            }
-        }
+DistanceSum measureGalaxies(const std::string fileName) {
+    DistanceSum sum = { 0, 0 };
+    std::ifstream inputFile(fileName);
+    if (inputFile.fail()) {
+        std::cout << "The file doesn't exist you dummy!" << std::endl;
+        return sum;
     }
 
-    std::vector<std::pair<int, int>> galaxyPositions;
-    for (int i1 = 0; i1 < input.size(); ++i1) {
-        for (int i2 = 0; i2 < input[i1].length(); ++i2) {
-            if (input[i1][i2] != '.') {
-                galaxyPositions.push_back(std::pair<int, int>(i1, i2));
-            }
+    // All that matters is how many galaxies are in each row and column.
+    std::vector<long long> rowGalaxyCounts;
+    std::vector<long long> colGalaxyCounts;
+    std::string line;
+    while (std::getline(inputFile, line)) {
+        if (colGalaxyCounts.size() < line.length()) {
+            colGalaxyCounts.resize(line.length(), 0);
         }
-    }
-
-    long long sum = 0;
-    for (int galaxyIndex1 = 0; galaxyIndex1 < galaxyPositions.size(); ++galaxyIndex1) {
-        for (int galaxyIndex2 = galaxyIndex1 + 1; galaxyIndex2 < galaxyPositions.size(); ++galaxyIndex2) {
-            long long distance = 0;
-
-            int smallX = std::min(galaxyPositions[galaxyIndex1].first, galaxyPositions[galaxyIndex2].first);
-            int bigX = std::max(galaxyPositions[galaxyIndex1].first, galaxyPositions[galaxyIndex2].first);
-            for (int xIndex = smallX + 1; xIndex <= bigX; ++xIndex) {
-                if (rowIsEmpty[xIndex]) {
-                    distance += multiplier;
-                }
-                else {
-                    distance += 1;
-                }
-            }
-
-            int smallY = std::min(galaxyPositions[galaxyIndex1].second, galaxyPositions[galaxyIndex2].second);
-            int bigY = std::max(galaxyPositions[galaxyIndex1].second, galaxyPositions[galaxyIndex2].second);
-            for (int yIndex = smallY + 1; yIndex <= bigY; ++yIndex) {
-                if (colIsEmpty[yIndex]) {
-                    distance += multiplier;
-                }
-                else {
-                    distance += 1;
-                }
+        long long rowGalaxyCount = 0;
+        for (size_t col = 0; col < line.length(); ++col) {
+            if (line[col] != '.') {
+                ++rowGalaxyCount;
+                ++colGalaxyCounts[col];
             }
-
-            sum += distance;
         }
+        rowGalaxyCounts.push_back(rowGalaxyCount);
     }
 
+    addAxisCrossings(rowGalaxyCounts, sum);
+    addAxisCrossings(colGalaxyCounts, sum);
     return sum;
 }
 
-std::vector<std::string> readLines(const std::string fileName) {
-    std::vector<std::string> lines;
-    std::ifstream inputFile(fileName);
-
-    if (inputFile.fail()) {
-        std::cout << "The file doesn't exist you dummy!" << std::endl;
-    }
-    else {
-        std::string line;
-        while (std::getline(inputFile, line)) {
-            lines.push_back(line);
+// Sweeps the lines of one axis in order. Counting occupied and empty lines
+// separately, each galaxy's distance to every galaxy before it is its own
+// position times how many came before, less the sum of their positions.
+void addAxisCrossings(const std::vector<long long>& galaxyCounts, DistanceSum& sum) {
+    long long galaxiesSeen = 0;
+    long long occupiedLinesSeen = 0;
+    long long emptyLinesSeen = 0;
+    long long occupiedPositionSum = 0;
+    long long emptyPositionSum = 0;
+    for (long long count : galaxyCounts) {
+        if (count == 0) {
+            ++emptyLinesSeen;
+            continue;
         }
-        inputFile.close();
+        sum.occupiedCrossings += count * (galaxiesSeen * occupiedLinesSeen - occupiedPositionSum);
+        sum.emptyCrossings += count * (galaxiesSeen * emptyLinesSeen - emptyPositionSum);
+        galaxiesSeen += count;
+        occupiedPositionSum += count * occupiedLinesSeen;
+        emptyPositionSum += count * emptyLinesSeen;
+        ++occupiedLinesSeen;
     }
-
-    return lines;
 }
@@ -7,202 +7,121 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <regex>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
 
-int solution1(const std::string fileName);
-std::vector<int> getDamagedSpringNumbers(const std::string springString);
-
-int solution2(const std::string fileName);
-int getNumberOfPossibleSpringStrings(const std::string springString, const std::vector<int>& damagedSpringNumbers);
-int processWorkingSpring(const std::string springString, const std::vector<int>& damagedSpringNumbers);
-int processDamagedSpring(const std::string springString, const std::vector<int>& damagedSpringNumbers);
+struct ConditionRecord {
+    std::string springs;
+    std::vector<int> damagedSpringNumbers;
+};
 
+long long solution(const std::string fileName, int unfoldFactor);
+ConditionRecord parseConditionRecord(const std::string& line, int unfoldFactor);
+uint64_t getNumberOfArrangements(const ConditionRecord& record);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
     std::cout << std::endl;
-    std::cout << "Example Solution 1: " << solution1("example.txt") << " (expected 21)" << std::endl;
-    std::cout << "Input Solution 1: " << solution1("input.txt") << std::endl;
-    std::cout << "" << std::endl;
-    std::cout << "Example Solution 2: " << solution2("example.txt") << " (expected 21)" << std::endl;
-    std::cout << "Input Solution 2: " << solution2("input.txt") << std::endl;
+    std::cout << "Example Solution: " << solution("example.txt", 1) << " (expected 21)" << std::endl;
+    std::cout << "Input Solution: " << solution("input.txt", 1) << std::endl;
     std::cout << std::endl;
 }
 
-int solution1(const std::string fileName) {
+long long solution(const std::string fileName, int unfoldFactor) {
     std::vector<std::string> input = readLines(fileName);
-    std::regex digitPattern("\\d+");
-
-    int total = 0;
-    for (std::string line : input) {
-        std::string originalSpringString = line.substr(0, line.find(" "));
-
-        std::vector<int> originalDamagedSpringNumbers;
-        std::sregex_iterator iterator(line.begin(), line.end(), digitPattern);
-        std::sregex_iterator end;
-        while (iterator != end) {
-            originalDamagedSpringNumbers.push_back(std::stoi((*iterator)[0]));
-            ++iterator;
-        }
 
-        std::vector<std::string> possibleSpringStrings = {originalSpringString};
-        for (int charIndex = 0; charIndex < originalSpringString.length(); ++charIndex) {
-            if (originalSpringString[charIndex] == '?') {
-                std::vector<std::string> newPossibleSpringStrings;
-                for (std::string possibleSpringString : possibleSpringStrings) {
-                    for (char c : std::vector<char>({'.', '#'})) {
-                        std::string newPossibleSpringString = possibleSpringString;
-                        newPossibleSpringString[charIndex] = c;
-
-                        std::vector<int> newPossibleDamagedSpringNumbers = getDamagedSpringNumbers(newPossibleSpringString);
-                        bool viable = true;
-                        for (int numberIndex = 0; numberIndex < newPossibleDamagedSpringNumbers.size(); ++numberIndex) {
-                            if (newPossibleDamagedSpringNumbers[numberIndex] != originalDamagedSpringNumbers[numberIndex]) {
-                                viable = false;
-                            }
-                        }
-                        if (viable) {
-                            newPossibleSpringStrings.push_back(newPossibleSpringString);
-                        }
-
-                    }
-                }
-                possibleSpringStrings = newPossibleSpringStrings;
+    // The lines are independent, so give each thread an even share of them.
+    std::vector<uint64_t> counts(input.size(), 0);
+    size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), input.size()));
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&, i]() {
+            for (size_t index = input.size() * i / threadCount; index < input.size() * (i + 1) / threadCount; ++index) {
+                counts[index] = getNumberOfArrangements(parseConditionRecord(input[index], unfoldFactor));
             }
-        }
-
-        int count = 0;
-        for (std::string possibleSpringString : possibleSpringStrings) {
-            std::vector<int> possibleDamagedSpringNumbers = getDamagedSpringNumbers(possibleSpringString);
-            if (possibleDamagedSpringNumbers == originalDamagedSpringNumbers) {
-                count += 1;
-            }
-        }
-        total += count;
+        });
     }
-    return total;
-}
-
-std::vector<int> getDamagedSpringNumbers(const std::string springString) {
-    std::vector<int> damagedSpringNumbers;
-    int count = 0;
-    for (int i = 0; i < springString.length(); ++i) {
-        if (springString[i] == '?') {
-            break;
-        }
-        else if (springString[i] == '#') {
-            count += 1;
-            if (i == springString.length() - 1) {
-                damagedSpringNumbers.push_back(count);
-            }
-        }
-        else if (springString[i] == '.' && count > 0) {
-            damagedSpringNumbers.push_back(count);
-            count = 0;
-        }
+    for (std::thread& thread : threads) {
+        thread.join();
     }
-    return damagedSpringNumbers;
-}
 
-int solution2(const std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
-    std::regex digitPattern("\\d+");
-
-    int total = 0;
-    for (std::string line : input) {
-        std::string springString = line.substr(0, line.find(" "));
-
-        std::vector<int> damagedSpringNumbers;
-        std::sregex_iterator iterator(line.begin(), line.end(), digitPattern);
-        std::sregex_iterator end;
-        while (iterator != end) {
-            damagedSpringNumbers.push_back(std::stoi((*iterator)[0]));
-            ++iterator;
-        }
-
-        int count = getNumberOfPossibleSpringStrings(springString, damagedSpringNumbers);
+    uint64_t total = 0;
+    for (uint64_t count : counts) {
         total += count;
     }
     return total;
 }
 
-int getNumberOfPossibleSpringStrings(const std::string springString, const std::vector<int>& damagedSpringNumbers) {
-    // If the spring string is empty, return 1 if there are no more damaged
-    // spring numbers left, or 0 otherwise.
-    if (springString.length() == 0) {
-        return damagedSpringNumbers.empty() ? 1 : 0;
-    }
-
-    // If there are no more damaged spring numbers left, return 1 only if the
-    // spring string does not contain any damaged springs, or 0 otherwise.
-    if (damagedSpringNumbers.empty()) {
-        for (char spring : springString) {
-            if (spring == '#') {
-                return 0;
-            }
+// Reads "???.### 1,1,3" and repeats it unfoldFactor times, joining the copies
+// of the springs with '?'.
+ConditionRecord parseConditionRecord(const std::string& line, int unfoldFactor) {
+    ConditionRecord folded;
+    size_t space = line.find(' ');
+    folded.springs = line.substr(0, space);
+    int number = 0;
+    for (size_t i = space + 1; space != std::string::npos && i <= line.length(); ++i) {
+        if (i < line.length() && line[i] >= '0' && line[i] <= '9') {
+            number = number * 10 + (line[i] - '0');
+        }
+        else {
+            folded.damagedSpringNumbers.push_back(number);
+            number = 0;
         }
-        return 1;
     }
 
-    // The spring string is not empty and there are damaged spring numbers left.
-    // Process the next spring.
-    int numberOfPossibleSpringStrings;
-    if (springString[0] == '.') {
-        numberOfPossibleSpringStrings = processWorkingSpring(springString, damagedSpringNumbers);
-    }
-    else if (springString[0] == '#') {
-        numberOfPossibleSpringStrings = processDamagedSpring(springString, damagedSpringNumbers);
+    ConditionRecord unfolded = folded;
+    for (int i = 1; i < unfoldFactor; ++i) {
+        unfolded.springs += '?';
+        unfolded.springs += folded.springs;
+        unfolded.damagedSpringNumbers.insert(unfolded.damagedSpringNumbers.end(), folded.damagedSpringNumbers.begin(), folded.damagedSpringNumbers.end());
     }
-    else if (springString[0] == '?') {
-        numberOfPossibleSpringStrings = processWorkingSpring(springString, damagedSpringNumbers) + processDamagedSpring(springString, damagedSpringNumbers);
-    }
-
-    return numberOfPossibleSpringStrings;
+    return unfolded;
 }
 
-int processWorkingSpring(const std::string springString, const std::vector<int>& damagedSpringNumbers) {
-    // Simply check the remainder of the string.
-    std::string newSpringString = springString.substr(1);
-    return getNumberOfPossibleSpringStrings(newSpringString, damagedSpringNumbers);
-}
-
-int processDamagedSpring(const std::string springString, const std::vector<int>& damagedSpringNumbers) {
-    // Get the group of springs that should satisfy the next number of damaged
-    // springs.
-    std::string group = springString.substr(0, damagedSpringNumbers[0]);
-
-    // If the group is too short to satisfy the number of damaged springs,
-    // return 0.
-    if (group.length() < damagedSpringNumbers[0]) {
-        return 0;
+// Bottom up over (group, position): ways[group][position] is the number of
+// ways to fit the groups from group onwards into the springs from position
+// onwards. Row numberCount has an extra group of "none left", which only
+// works if there are no damaged springs left either.
+uint64_t getNumberOfArrangements(const ConditionRecord& record) {
+    const std::string& springs = record.springs;
+    const std::vector<int>& numbers = record.damagedSpringNumbers;
+    const size_t length = springs.length();
+    const size_t numberCount = numbers.size();
+    const size_t rowWidth = length + 1;
+
+    // How many springs from each position on could all be damaged. A group of
+    // size k fits at i if that's at least k and the spring after it isn't
+    // damaged.
+    std::vector<size_t> runLengths(length + 1, 0);
+    for (size_t i = length; i-- > 0;) {
+        runLengths[i] = springs[i] == '.' ? 0 : runLengths[i + 1] + 1;
     }
-
-    // If the group contains any operational springs, return 0 as it does not
-    // satisfy the number of damaged springs.
-    for (char spring : group) {
-        if (spring == '.') {
-            return 0;
-        }
+    auto canPlace = [&](size_t position, size_t size) {
+        return runLengths[position] >= size && (position + size == length || springs[position + size] != '#');
+    };
+
+    std::vector<uint64_t> ways((numberCount + 1) * rowWidth, 0);
+    uint64_t* lastRow = &ways[numberCount * rowWidth];
+    lastRow[length] = 1;
+    for (size_t i = length; i-- > 0;) {
+        lastRow[i] = springs[i] == '#' ? 0 : lastRow[i + 1];
     }
 
-    // If the group is the entirety of the spring string, return 1 if there are
-    // no other damaged spring numbers, or 0 otherwise.
-    if (group.length() == springString.length()) {
-        return damagedSpringNumbers.size() - 1 == 0 ? 1 : 0;
-    }
-    // Otherwise, check the spring following the group. If it is damaged, return
-    // 0 as the group is too big.
-    else if (springString[damagedSpringNumbers[0]] == '#') {
-        return 0;
+    for (size_t group = numberCount; group-- > 0;) {
+        uint64_t* row = &ways[group * rowWidth];
+        const uint64_t* nextRow = row + rowWidth;
+        const size_t size = numbers[group];
+        for (size_t i = length; i-- > 0;) {
+            uint64_t count = springs[i] == '#' ? 0 : row[i + 1];
+            if (canPlace(i, size)) {
+                count += nextRow[std::min(i + size + 1, length)];
+            }
+            row[i] = count;
+        }
     }
 
-    // There is a sufficient number of damaged and unknown springs to satisfy
-    // the next number of damaged springs, and there is an operational spring to
-    // separate the group from the remaining springs. Check the remaining
-    // springs against the remaining damaged spring numbers.
-    std::string newSpringString = springString.substr(damagedSpringNumbers[0] + 1); // + 1 to move past the operational spring following the group
-    std::vector<int> newDamagedSpringNumbers(damagedSpringNumbers.begin() + 1, damagedSpringNumbers.end());
-    return getNumberOfPossibleSpringStrings(newSpringString, newDamagedSpringNumbers);
+    return ways[0];
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
@@ -7,93 +7,116 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+// Every row (or every column) of a pattern as a bitmask with a bit set for
+// each rock. Lines longer than 64 spill over into more words.
+class PatternLines {
+private:
+    size_t wordsPerLine;
+    size_t lineCount;
+    std::vector<uint64_t> words;
+
+public:
+    PatternLines(size_t lineCount, size_t lineLength) : wordsPerLine((lineLength + 63) / 64), lineCount(lineCount), words(lineCount * wordsPerLine, 0) {}
+
+    void setRock(size_t line, size_t position) {
+        words[line * wordsPerLine + position / 64] |= uint64_t(1) << (position % 64);
+    }
+
+    size_t getLineCount() const {
+        return lineCount;
+    }
 
-int solution(const std::string fileName);
+    int countDifferences(size_t line1, size_t line2) const {
+        int differences = 0;
+        for (size_t word = 0; word < wordsPerLine; ++word) {
+            differences += std::popcount(words[line1 * wordsPerLine + word] ^ words[line2 * wordsPerLine + word]);
+        }
+        return differences;
+    }
+};
+
+// The summarised notes for both parts: the exact reflections and the ones
+// that need one smudge cleaned.
+struct Summary {
+    long long exact;
+    long long smudged;
+};
+
+Summary solution(const std::string fileName);
+void addReflections(const PatternLines& lines, int weight, Summary& summary);
+void addPattern(const std::vector<std::string>& pattern, Summary& summary);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
     std::cout << std::endl;
-    std::cout << "Example Solution: " << solution("example.txt") << " (expected 405)" << std::endl;
-    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
+    std::cout << "Example Solution: " << solution("example.txt").exact << " (expected 405)" << std::endl;
+    std::cout << "Input Solution: " << solution("input.txt").exact << std::endl;
     std::cout << std::endl;
 }
 
-int solution(const std::string fileName) {
+Summary solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
 
-    std::vector<std::vector<std::vector<char>>> grids;
-    std::vector<std::vector<char>> grid;
-    for (int i1 = 0; i1 < input.size(); ++i1) {
-        if (input[i1].empty()) {
-            grids.push_back(grid);
-            grid = {};
+    Summary summary = { 0, 0 };
+    std::vector<std::string> pattern;
+    for (const std::string& line : input) {
+        if (line.empty()) {
+            addPattern(pattern, summary);
+            pattern.clear();
         }
         else {
-            std::vector<char> row;
-            for (int i2 = 0; i2 < input[i1].length(); ++i2) {
-                row.push_back(input[i1][i2]);
-            }
-            grid.push_back(row);
+            pattern.push_back(line);
         }
     }
-    grids.push_back(grid);
-
-    int total = 0;
-
-    for (std::vector<std::vector<char>> grid : grids) {
-        for (int mirrorIndex = 0; mirrorIndex < grid.size() - 1; ++mirrorIndex) {
-            int maxOffset = std::min(mirrorIndex, static_cast<int>((grid.size() - 1) - (mirrorIndex + 1)));
-            bool equal = true;
-            for (int offset = 0; offset <= maxOffset; ++offset) {
-                std::string top;
-                for (char c : grid[mirrorIndex - offset]) {
-                    top += c;
-                }
-
-                std::string bottom;
-                for (char c : grid[mirrorIndex + 1 + offset]) {
-                    bottom += c;
-                }
-
-                if (top != bottom) {
-                    equal = false;
-                    break;
-                }
-            }
-            if (equal) {
-                total += (mirrorIndex + 1) * 100;
-                break;
-            }
-        }
+    addPattern(pattern, summary);
 
-        for (int mirrorIndex = 0; mirrorIndex < grid[0].size() - 1; ++mirrorIndex) {
-            int maxOffset = std::min(mirrorIndex, static_cast<int>((grid[0].size() - 1) - (mirrorIndex + 1)));
-            bool equal = true;
-            for (int offset = 0; offset <= maxOffset; ++offset) {
-                std::string left;
-                for (std::vector<char> row : grid) {
-                    left += row[mirrorIndex - offset];
-                }
-
-                std::string right;
-                for (std::vector<char> row : grid) {
-                    right += row[mirrorIndex + 1 + offset];
-                }
-
-                if (left != right) {
-                    equal = false;
-                    break;
-                }
-            }
-            if (equal) {
-                total += mirrorIndex + 1;
-                break;
+    return summary;
+}
+
+void addPattern(const std::vector<std::string>& pattern, Summary& summary) {
+    if (pattern.empty()) {
+        return;
+    }
+
+    PatternLines rows(pattern.size(), pattern[0].length());
+    PatternLines cols(pattern[0].length(), pattern.size());
+    for (size_t row = 0; row < pattern.size(); ++row) {
+        for (size_t col = 0; col < pattern[row].length(); ++col) {
+            if (pattern[row][col] == '#') {
+                rows.setRock(row, col);
+                cols.setRock(col, row);
             }
         }
     }
 
-    return total;
+    addReflections(rows, 100, summary);
+    addReflections(cols, 1, summary);
+}
+
+// Tries a mirror after every line, counting how many cells differ between
+// the lines it reflects onto each other. None means an exact reflection and
+// one means a reflection with a smudge; any more and the mirror is given up.
+void addReflections(const PatternLines& lines, int weight, Summary& summary) {
+    bool foundExact = false;
+    bool foundSmudged = false;
+    const size_t lineCount = lines.getLineCount();
+    for (size_t mirror = 1; mirror < lineCount && !(foundExact && foundSmudged); ++mirror) {
+        int differences = 0;
+        for (size_t offset = 0; offset < mirror && mirror + offset < lineCount && differences <= 1; ++offset) {
+            differences += lines.countDifferences(mirror - 1 - offset, mirror + offset);
+        }
+        if (differences == 0 && !foundExact) {
+            summary.exact += mirror * weight;
+            foundExact = true;
+        }
+        else if (differences == 1 && !foundSmudged) {
+            summary.smudged += mirror * weight;
+            foundSmudged = true;
+        }
+    }
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
@@ -8,137 +8,265 @@
 #include <vector>
 #include <fstream>
 #include <algorithm>
+#include <unordered_map>
+#include <bit>
+#include <cstdint>
 
-enum Direction { NORTH, WEST, SOUTH, EAST };
+// A grid of bits stored one line at a time, each line padded to whole words.
+class Bitboard {
+private:
+    size_t lineCount;
+    size_t wordsPerLine;
+    std::vector<uint64_t> words;
 
-int solution(const std::string fileName);
-void spin(std::vector<std::string>& input);
-void slideRock(std::vector<std::string>& input, const int rockRow, const int rockCol, const int direction);
-std::vector<std::string> readLines(const std::string fileName);
+    // Calls f(word, mask) for every word overlapping [start, end) of a line,
+    // where mask covers the bits of that word inside the range.
+    template <typename F>
+    void forEachWord(size_t line, size_t start, size_t end, F f) {
+        uint64_t* lineWords = &words[line * wordsPerLine];
+        for (size_t word = start / 64; word * 64 < end; ++word) {
+            size_t from = std::max(start, word * 64) - word * 64;
+            size_t to = std::min(end, word * 64 + 64) - word * 64;
+            uint64_t mask = (to == 64 ? ~uint64_t(0) : (uint64_t(1) << to) - 1) & ~((uint64_t(1) << from) - 1);
+            f(lineWords[word], mask);
+        }
+    }
 
-int main() {
-    std::cout << std::endl;
-    std::cout << "Example Solution: " << solution("example.txt") << " (expected 64)" << std::endl;
-    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
-    std::cout << std::endl;
-}
+public:
+    Bitboard(size_t lineCount, size_t lineLength) : lineCount(lineCount), wordsPerLine((lineLength + 63) / 64), words(lineCount * wordsPerLine, 0) {}
 
-int solution(const std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
-    int desiredSpinNumber = 1000000000;
+    void set(size_t line, size_t position) {
+        words[line * wordsPerLine + position / 64] |= uint64_t(1) << (position % 64);
+    }
+
+    int countLine(size_t line) const {
+        int count = 0;
+        for (size_t word = 0; word < wordsPerLine; ++word) {
+            count += std::popcount(words[line * wordsPerLine + word]);
+        }
+        return count;
+    }
 
-    std::vector<std::string> gridStringHistory;
-    int currentSpinNumber = 0;
-    int cycleStartNumber;
-    int cycleLength;
+    // Gathers all the set bits in [start, end) at one end of the range.
+    void settle(size_t line, size_t start, size_t end, bool towardsStart) {
+        // Most ranges sit inside a single word.
+        size_t firstWord = start / 64;
+        if ((end - 1) / 64 == firstWord) {
+            uint64_t& word = words[line * wordsPerLine + firstWord];
+            size_t from = start - firstWord * 64;
+            size_t to = end - firstWord * 64;
+            uint64_t mask = (to == 64 ? ~uint64_t(0) : (uint64_t(1) << to) - 1) & ~((uint64_t(1) << from) - 1);
+            int count = std::popcount(word & mask);
+            uint64_t fill = count == 0 ? 0 : (~uint64_t(0) >> (64 - count)) << (towardsStart ? from : to - count);
+            word = (word & ~mask) | fill;
+            return;
+        }
 
-    bool cycleFound = false;
-    while (!cycleFound) {
-        spin(input);
-        ++currentSpinNumber;
+        int count = 0;
+        forEachWord(line, start, end, [&](uint64_t& word, uint64_t mask) {
+            count += std::popcount(word & mask);
+            word &= ~mask;
+        });
+        if (count > 0) {
+            size_t fillStart = towardsStart ? start : end - count;
+            forEachWord(line, fillStart, fillStart + count, [](uint64_t& word, uint64_t mask) {
+                word |= mask;
+            });
+        }
+    }
 
-        std::string gridString;
-        for (std::string line : input) {
-            gridString += line;
+    // Writes the transpose of this board into other, which must have a line
+    // for every position of this one. Works through 64x64 blocks of bits.
+    void transposeInto(Bitboard& other) const {
+        uint64_t block[64];
+        for (size_t lineBlock = 0; lineBlock * 64 < lineCount; ++lineBlock) {
+            for (size_t word = 0; word < wordsPerLine; ++word) {
+                for (size_t i = 0; i < 64; ++i) {
+                    size_t line = lineBlock * 64 + i;
+                    block[i] = line < lineCount ? words[line * wordsPerLine + word] : 0;
+                }
+                transposeBlock(block);
+                for (size_t i = 0; i < 64 && word * 64 + i < other.lineCount; ++i) {
+                    other.words[(word * 64 + i) * other.wordsPerLine + lineBlock] = block[i];
+                }
+            }
         }
+    }
 
-        std::vector<std::string>::iterator iterator = std::find(gridStringHistory.begin(), gridStringHistory.end(), gridString);
-        if (iterator != gridStringHistory.end()) {
-            cycleFound = true;
-            cycleStartNumber = (iterator - gridStringHistory.begin()) + 1;
-            cycleLength = currentSpinNumber - cycleStartNumber;
+    // Swaps bit j of word i with bit i of word j, by swapping ever smaller
+    // off-diagonal sub-blocks.
+    static void transposeBlock(uint64_t* block) {
+        uint64_t mask = 0x00000000FFFFFFFF;
+        for (int j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+            for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                uint64_t swapped = ((block[k] >> j) ^ block[k | j]) & mask;
+                block[k | j] ^= swapped;
+                block[k] ^= swapped << j;
+            }
         }
+    }
+
+    const std::vector<uint64_t>& getWords() const {
+        return words;
+    }
+};
+
+// A 128-bit hash of a board, so telling boards apart by hash alone would
+// almost never go wrong. A match is still checked before it's trusted.
+struct BoardHash {
+    uint64_t low;
+    uint64_t high;
 
-        gridStringHistory.push_back(gridString);
+    bool operator==(const BoardHash& other) const {
+        return low == other.low && high == other.high;
     }
+};
 
-    int desiredCycleNumber = ((desiredSpinNumber - cycleStartNumber) % cycleLength) + cycleStartNumber;
-    std::string gridString = gridStringHistory[desiredCycleNumber - 1];
+struct BoardHashHasher {
+    size_t operator()(const BoardHash& hash) const {
+        return hash.low;
+    }
+};
+
+// The round rocks on the platform, kept both as rows and as columns so every
+// tilt runs along lines. Between the cube rocks each line splits into fixed
+// segments, and tilting a segment just counts its round rocks and stacks
+// them up against one end.
+class Platform {
+private:
+    struct Segment {
+        size_t line;
+        size_t start;
+        size_t end;
+    };
 
-    int rowIndex = 0;
-    int colIndex = 0;
-    int maxColIndex = input[0].length() - 1;
-    for (int charIndex = 0; charIndex < gridString.length(); ++charIndex) {
-        input[rowIndex][colIndex] = gridString[charIndex];
+    size_t height;
+    size_t width;
+    Bitboard rows;
+    Bitboard cols;
+    std::vector<Segment> rowSegments;
+    std::vector<Segment> colSegments;
 
-        ++colIndex;
-        if (colIndex > maxColIndex) {
-            colIndex = 0;
-            ++rowIndex;
+    static void tilt(Bitboard& board, const std::vector<Segment>& segments, bool towardsStart) {
+        for (const Segment& segment : segments) {
+            board.settle(segment.line, segment.start, segment.end, towardsStart);
         }
     }
 
-    int total = 0;
-    for (int rockRow = 0; rockRow < input.size(); ++rockRow) {
-            for (int rockCol = 0; rockCol < input[0].length(); ++rockCol) {
-                if (input[rockRow][rockCol] == 'O') {
-                    total += input.size() - rockRow;
+public:
+    Platform(const std::vector<std::string>& input) :
+        height(input.size()), width(input.empty() ? 0 : input[0].length()),
+        rows(height, width), cols(width, height) {
+        for (size_t row = 0; row < height; ++row) {
+            size_t start = 0;
+            for (size_t col = 0; col <= width; ++col) {
+                if (col == width || input[row][col] == '#') {
+                    if (col - start > 1) {
+                        rowSegments.push_back({ row, start, col });
+                    }
+                    start = col + 1;
+                }
+                else if (input[row][col] == 'O') {
+                    rows.set(row, col);
                 }
             }
         }
-    return total;
-}
-
-void spin(std::vector<std::string>& input) {
-    for (int rockRow = 1; rockRow < input.size(); ++rockRow) {
-        for (int rockCol = 0; rockCol < input[0].length(); ++rockCol) {
-            if (input[rockRow][rockCol] == 'O') {
-                slideRock(input, rockRow, rockCol, NORTH);
+        for (size_t col = 0; col < width; ++col) {
+            size_t start = 0;
+            for (size_t row = 0; row <= height; ++row) {
+                if (row == height || input[row][col] == '#') {
+                    if (row - start > 1) {
+                        colSegments.push_back({ col, start, row });
+                    }
+                    start = row + 1;
+                }
             }
         }
     }
 
-    for (int rockCol = 1; rockCol < input[0].length(); ++rockCol) {
-        for (int rockRow = 0; rockRow < input.size(); ++rockRow) {
-            if (input[rockRow][rockCol] == 'O') {
-                slideRock(input, rockRow, rockCol, WEST);
-            }
+    // North, west, south, east. The rows are the up to date copy in between.
+    void spin() {
+        rows.transposeInto(cols);
+        tilt(cols, colSegments, true);
+        cols.transposeInto(rows);
+        tilt(rows, rowSegments, true);
+        rows.transposeInto(cols);
+        tilt(cols, colSegments, false);
+        cols.transposeInto(rows);
+        tilt(rows, rowSegments, false);
+    }
+
+    long long getNorthLoad() const {
+        long long load = 0;
+        for (size_t row = 0; row < height; ++row) {
+            load += static_cast<long long>(rows.countLine(row)) * (height - row);
         }
+        return load;
     }
 
-    for (int rockRow = input.size() - 2; rockRow >= 0; --rockRow) {
-        for (int rockCol = 0; rockCol < input[0].length(); ++rockCol) {
-            if (input[rockRow][rockCol] == 'O') {
-                slideRock(input, rockRow, rockCol, SOUTH);
-            }
+    BoardHash getHash() const {
+        BoardHash hash = { 0x9E3779B97F4A7C15, 0xC2B2AE3D27D4EB4F };
+        for (uint64_t word : rows.getWords()) {
+            hash.low = (hash.low ^ word) * 0xBF58476D1CE4E5B9;
+            hash.low ^= hash.low >> 31;
+            hash.high = (hash.high + word) * 0x94D049BB133111EB;
+            hash.high ^= hash.high >> 29;
         }
+        return hash;
+    }
+
+    const std::vector<uint64_t>& getRocks() const {
+        return rows.getWords();
     }
+};
 
-    for (int rockCol = input[0].length() - 2; rockCol >= 0; --rockCol) {
-        for (int rockRow = 0; rockRow < input.size(); ++rockRow) {
-            if (input[rockRow][rockCol] == 'O') {
-                slideRock(input, rockRow, rockCol, EAST);
+long long solution(const std::string fileName, long long desiredSpinNumber);
+std::vector<std::string> readLines(const std::string fileName);
+
+int main() {
+    std::cout << std::endl;
+    std::cout << "Example Solution: " << solution("example.txt", 1000000000) << " (expected 64)" << std::endl;
+    std::cout << "Input Solution: " << solution("input.txt", 1000000000) << std::endl;
+    std::cout << std::endl;
+}
+
+long long solution(const std::string fileName, long long desiredSpinNumber) {
+    std::vector<std::string> input = readLines(fileName);
+    Platform platform(input);
+
+    // loads[n] is the load after n spins.
+    std::vector<long long> loads = { platform.getNorthLoad() };
+    std::unordered_map<BoardHash, size_t, BoardHashHasher> spinNumbersByHash = { { platform.getHash(), 0 } };
+    size_t cycleStartNumber = 0;
+    size_t cycleLength = 0;
+    while (static_cast<long long>(loads.size()) <= desiredSpinNumber && cycleLength == 0) {
+        platform.spin();
+        loads.push_back(platform.getNorthLoad());
+        size_t currentSpinNumber = loads.size() - 1;
+
+        auto [iterator, inserted] = spinNumbersByHash.try_emplace(platform.getHash(), currentSpinNumber);
+        if (!inserted) {
+            // Make sure it's a real repeat and not a hash collision by spinning
+            // round the supposed cycle once more and checking we get back to
+            // exactly the same rocks.
+            size_t candidateLength = currentSpinNumber - iterator->second;
+            iterator->second = currentSpinNumber;
+            std::vector<uint64_t> rocks = platform.getRocks();
+            for (size_t spin = 0; spin < candidateLength; ++spin) {
+                platform.spin();
+                loads.push_back(platform.getNorthLoad());
+            }
+            if (platform.getRocks() == rocks) {
+                cycleStartNumber = currentSpinNumber;
+                cycleLength = candidateLength;
             }
         }
     }
-}
 
-void slideRock(std::vector<std::string>& input, const int rockRow, const int rockCol, const int direction) {
-    int rowOffset = 0;
-    int colOffset = 0;
-    switch (direction) {
-        case NORTH:
-            rowOffset = -1;
-            break;
-        case WEST:
-            colOffset = -1;
-            break;
-        case SOUTH:
-            rowOffset = 1;
-            break;
-        case EAST:
-            colOffset = 1;
-            break;
-    }
-
-    if (rockRow + rowOffset >= 0 && rockRow + rowOffset < input.size() &&
-        rockCol + colOffset >= 0 && rockCol + colOffset < input[0].length() &&
-        input[rockRow + rowOffset][rockCol + colOffset] == '.')
-    {
-        input[rockRow][rockCol] = '.';
-        input[rockRow + rowOffset][rockCol + colOffset] = 'O';
-        slideRock(input, rockRow + rowOffset, rockCol + colOffset, direction);
+    if (desiredSpinNumber < static_cast<long long>(loads.size())) {
+        return loads[desiredSpinNumber];
     }
+    return loads[cycleStartNumber + (desiredSpinNumber - cycleStartNumber) % cycleLength];
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
@@ -7,10 +7,10 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <sstream>
+#include <cstdint>
 
 int solution(const std::string fileName);
-int hash(std::string str);
+uint8_t hashStep(uint8_t value, char c);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
@@ -22,30 +22,30 @@ int main() {
 
 int solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
-
-    std::vector<std::string> instructions;
-    std::istringstream ss(input[0]);
-    std::string instruction;
-    while (std::getline(ss, instruction, ',')) {
-        instructions.push_back(instruction);
+    if (input.empty()) {
+        return 0;
     }
 
+    // Hash each step as it's read instead of splitting the line up first.
     int total = 0;
-    for (std::string instruction : instructions) {
-        int hashedInstruction = hash(instruction);
-        total += hashedInstruction;
+    uint8_t value = 0;
+    for (char c : input[0]) {
+        if (c == ',') {
+            total += value;
+            value = 0;
+        }
+        else {
+            value = hashStep(value, c);
+        }
     }
+    total += value;
     return total;
 }
 
-int hash(std::string str) {
-    int value = 0;
-    for (char c : str) {
-        value += c;
-        value *= 17;
-        value %= 256;
-    }
-    return value;
+// One character of the HASH algorithm. Keeping the value in a byte does the
+// remainder by 256 for free.
+uint8_t hashStep(uint8_t value, char c) {
+    return static_cast<uint8_t>((value + c) * 17);
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
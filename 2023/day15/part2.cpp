@@ -5,77 +5,152 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
-#include <sstream>
-#include <list>
+#include <array>
 #include <algorithm>
+#include <cstdint>
 
-template <class K, class V>
-class HashMap {
+// A short string kept inline, so keys never need a heap allocation. The
+// unused characters are always zero, which lets equality compare the arrays.
+template <size_t Capacity>
+class FixedString {
 private:
-    int multiplier = 17;
-    int capacity = 256;
-    std::vector<std::list<std::pair<K, V>>> buckets;
+    std::array<char, Capacity> characters = {};
+    uint8_t length = 0;
 
 public:
-    HashMap() : buckets(capacity) {};
+    FixedString() {}
 
-    V& operator[](const K key) {
-        std::list<std::pair<K, V>>& bucket = buckets[hash(key)];
-        typename std::list<std::pair<K, V>>::iterator iterator = std::find_if(bucket.begin(), bucket.end(), [key](const std::pair<K, V>& pair) {return pair.first == key;});
-        if (iterator != bucket.end()) {
-            return iterator->second;
-        }
-        else {
-            bucket.emplace_back(key, V{});
-            return bucket.back().second;
-        }
+    FixedString(const char* begin, size_t length) : length(static_cast<uint8_t>(length)) {
+        std::copy(begin, begin + length, characters.begin());
     }
 
-    const V& get(const K key) const {
-        const std::list<std::pair<K, V>>& bucket = buckets[hash(key)];
-        typename std::list<std::pair<K, V>>::const_iterator iterator = std::find_if(bucket.begin(), bucket.end(), [key](const std::pair<K, V>& pair) {return pair.first == key;});
-        if (iterator != bucket.end()) {
-            return iterator->second;
-        }
+    static constexpr size_t getCapacity() {
+        return Capacity;
+    }
+
+    std::string_view view() const {
+        return std::string_view(characters.data(), length);
+    }
+
+    bool operator==(const FixedString& other) const {
+        return length == other.length && characters == other.characters;
+    }
+};
+
+// The HASH algorithm, one character at a time. Keeping the value in a byte
+// does the remainder by 256 for free.
+struct HolidayHash {
+    static uint8_t step(uint8_t value, char c) {
+        return static_cast<uint8_t>((value + c) * 17);
     }
 
-    void insert(const K key, const V value) {
-        std::list<std::pair<K, V>>& bucket = buckets[hash(key)];
-        typename std::list<std::pair<K, V>>::iterator iterator = std::find_if(bucket.begin(), bucket.end(), [key](const std::pair<K, V>& pair) {return pair.first == key;});
-        if (iterator != bucket.end()) {
-            iterator->second = value;
+    template <size_t Capacity>
+    size_t operator()(const FixedString<Capacity>& key) const {
+        uint8_t value = 0;
+        for (char c : key.view()) {
+            value = step(value, c);
         }
-        else {
-            bucket.emplace_back(key, value);
+        return value;
+    }
+};
+
+// A hash map with a fixed number of buckets that remembers the order entries
+// were added to each bucket. Every bucket is a small contiguous vector.
+// Removing an entry only marks it, so the entries after it keep their order
+// without shuffling, and a bucket is compacted once half of it is removed
+// entries. Callers that already know a key's bucket can pass it in and skip
+// hashing the key again.
+template <class K, class V, class Hash, size_t BucketCount>
+class HashMap {
+private:
+    struct Entry {
+        K key;
+        V value;
+        bool removed;
+    };
+
+    struct Bucket {
+        std::vector<Entry> entries;
+        size_t removedCount = 0;
+    };
+
+    std::vector<Bucket> buckets;
+    Hash hasher;
+
+    static Entry* find(Bucket& bucket, const K& key) {
+        for (Entry& entry : bucket.entries) {
+            if (!entry.removed && entry.key == key) {
+                return &entry;
+            }
         }
+        return nullptr;
+    }
+
+public:
+    HashMap() : buckets(BucketCount) {}
+
+    V& operator[](const K& key) {
+        return getOrInsert(hasher(key), key);
     }
 
-    void remove(const K key) {
-        std::list<std::pair<K, V>>& bucket = buckets[hash(key)];
-        typename std::list<std::pair<K, V>>::iterator iterator = std::find_if(bucket.begin(), bucket.end(), [key](const std::pair<K, V>& pair) {return pair.first == key;});
-        if (iterator != bucket.end()) {
-            bucket.erase(iterator);
+    V& getOrInsert(size_t bucketIndex, const K& key) {
+        Bucket& bucket = buckets[bucketIndex];
+        Entry* entry = find(bucket, key);
+        if (entry == nullptr) {
+            bucket.entries.push_back({ key, V{}, false });
+            entry = &bucket.entries.back();
         }
+        return entry->value;
     }
 
-    const std::vector<std::list<std::pair<K, V>>>& getBuckets() const {
-        return buckets;
+    void insert(const K& key, const V& value) {
+        insert(hasher(key), key, value);
     }
 
-private:
-    int hash(const std::string str) const {
-        int value = 0;
-        for (char c : str) {
-            value += c;
-            value *= multiplier;
-            value %= capacity;
+    void insert(size_t bucketIndex, const K& key, const V& value) {
+        getOrInsert(bucketIndex, key) = value;
+    }
+
+    bool remove(const K& key) {
+        return remove(hasher(key), key);
+    }
+
+    bool remove(size_t bucketIndex, const K& key) {
+        Bucket& bucket = buckets[bucketIndex];
+        Entry* entry = find(bucket, key);
+        if (entry == nullptr) {
+            return false;
+        }
+        entry->removed = true;
+        ++bucket.removedCount;
+        if (bucket.removedCount * 2 >= bucket.entries.size()) {
+            std::erase_if(bucket.entries, [](const Entry& entry) { return entry.removed; });
+            bucket.removedCount = 0;
+        }
+        return true;
+    }
+
+    // Calls f(bucketIndex, slot, key, value) for every entry, bucket by
+    // bucket, with slot counting up from 0 in the order entries were added.
+    template <class F>
+    void forEach(F f) const {
+        for (size_t bucketIndex = 0; bucketIndex < buckets.size(); ++bucketIndex) {
+            size_t slot = 0;
+            for (const Entry& entry : buckets[bucketIndex].entries) {
+                if (!entry.removed) {
+                    f(bucketIndex, slot++, entry.key, entry.value);
+                }
+            }
         }
-        return value;
     }
 };
 
+typedef FixedString<15> Label;
+typedef HashMap<Label, int, HolidayHash, 256> LensBoxes;
+
 int solution(const std::string fileName);
 std::vector<std::string> readLines(const std::string fileName);
 
@@ -88,41 +163,52 @@ int main() {
 
 int solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
-
-    std::vector<std::string> instructions;
-    std::istringstream ss(input[0]);
-    std::string instruction;
-    while (std::getline(ss, instruction, ',')) {
-        instructions.push_back(instruction);
+    if (input.empty()) {
+        return 0;
     }
 
-    HashMap<std::string, int> hashmap;
-    for (const std::string instruction : instructions) {
-        std::string label;
-        int focalLength;
-        if (instruction.back() == '-') {
-            label = instruction.substr(0, instruction.length() - 1);
-            hashmap.remove(label);
+    // Walk the steps in place, hashing each label as it's read so its box is
+    // already known by the time the operation character turns up.
+    const std::string& steps = input[0];
+    LensBoxes boxes;
+    size_t labelStart = 0;
+    uint8_t box = 0;
+    bool inLabel = true;
+    for (size_t i = 0; i < steps.length(); ++i) {
+        char c = steps[i];
+        if (c == ',') {
+            labelStart = i + 1;
+            box = 0;
+            inLabel = true;
+        }
+        else if (inLabel && (c == '-' || c == '=')) {
+            size_t labelLength = i - labelStart;
+            if (labelLength > Label::getCapacity()) {
+                std::cout << "That label is too long!" << std::endl;
+                return 0;
+            }
+            Label label(&steps[labelStart], labelLength);
+            if (c == '-') {
+                boxes.remove(box, label);
+            }
+            else {
+                int focalLength = 0;
+                while (i + 1 < steps.length() && steps[i + 1] >= '0' && steps[i + 1] <= '9') {
+                    focalLength = focalLength * 10 + (steps[++i] - '0');
+                }
+                boxes.insert(box, label, focalLength);
+            }
+            inLabel = false;
         }
-        else {
-            label = instruction.substr(0, instruction.length() - 2);
-            focalLength = instruction.back() - '0';
-            // Either one of the two lines below should work.
-            //hashmap[label] = focalLength;
-            hashmap.insert(label, focalLength);
+        else if (inLabel) {
+            box = HolidayHash::step(box, c);
         }
     }
 
     int total = 0;
-    const std::vector<std::list<std::pair<std::string, int>>>& buckets = hashmap.getBuckets();
-    for (int bucketIndex = 0; bucketIndex < buckets.size(); ++bucketIndex) {
-        const std::list<std::pair<std::string, int>>& bucket = buckets[bucketIndex];
-        int lensNumber = 1;
-        for (std::list<std::pair<std::string, int>>::const_iterator iterator = bucket.begin(); iterator != bucket.end(); ++iterator) {
-            total += (bucketIndex + 1) * lensNumber * iterator->second;
-            ++lensNumber;
-        }
-    }
+    boxes.forEach([&](size_t boxIndex, size_t slot, const Label&, int focalLength) {
+        total += (boxIndex + 1) * (slot + 1) * focalLength;
+    });
     return total;
 }
 
@@ -7,121 +7,185 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <array>
 #include <algorithm>
+#include <bit>
+#include <cstdint>
 
 enum Direction { RIGHT, DOWN, LEFT, UP };
 
-int solution(const std::string fileName);
-void travel(const int rowIndex, const int colIndex, const Direction direction, const std::vector<std::string>& input, std::vector<std::vector<char>>& energyGrid, std::vector<std::string>& history);
-std::vector<std::string> readLines(const std::string fileName);
+// The contraption as a graph. A state is a beam entering one of the mirrors
+// or splitters in a given direction. Leaving it, the beam goes straight along
+// a run of empty tiles until it reaches the next state or the edge of the
+// grid, so a beam is followed a run at a time rather than a tile at a time.
+class BeamGraph {
+private:
+    // Empty tiles in a straight line, not including the tile the run ends at.
+    struct Run {
+        int startCell;
+        Direction direction;
+        int length;
+    };
 
-int main() {
-    std::cout << std::endl;
-    std::cout << "Example Solution: " << solution("example.txt") << " (expected 46)" << std::endl;
-    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
-    std::cout << std::endl;
-}
+    // Where a beam goes: the run it travels along first, then the state it
+    // arrives at, or -1 if it leaves the grid.
+    struct Beam {
+        Run run;
+        int state;
+    };
 
-int solution(const std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
-    std::vector<std::vector<char>> energyGrid = std::vector<std::vector<char>>(input.size(), std::vector<char>(input[0].length(), '.'));
-    std::vector<std::string> history;
+    static const int noState = -1;
 
-    travel(0, 0, RIGHT, input, energyGrid, history);
+    int height;
+    int width;
+    size_t wordsPerGrid;
+    std::vector<int> nodeCells;
+    std::vector<int> nodeIndices;
+    std::vector<std::array<Beam, 2>> stateBeams;
 
-    int total = 0;
-    for (int i1 = 0; i1 < energyGrid.size(); ++i1) {
-        for (int i2 = 0; i2 < energyGrid[0].size(); ++i2) {
-            if (energyGrid[i1][i2] == '#') {
-                total += 1;
-            }
-        }
+    static int getRowStep(Direction direction) {
+        return direction == DOWN ? 1 : direction == UP ? -1 : 0;
     }
-    return total;
-}
 
-void travel(const int rowIndex, const int colIndex, const Direction direction, const std::vector<std::string>& input, std::vector<std::vector<char>>& energyGrid, std::vector<std::string>& history) {
-    if (rowIndex < 0 || rowIndex >= input.size() || colIndex < 0 || colIndex >= input[0].length()) {
-        return;
+    static int getColStep(Direction direction) {
+        return direction == RIGHT ? 1 : direction == LEFT ? -1 : 0;
     }
 
-    std::string historyString = std::to_string(rowIndex) + " " + std::to_string(colIndex) + " " + std::to_string(direction);
-    if (std::find(history.begin(), history.end(), historyString) != history.end()) {
-        return;
-    }
-    history.push_back(historyString);
-
-    energyGrid[rowIndex][colIndex] = '#';
-
-    int rowOffset = 0;
-    int colOffset = 0;
-    switch (direction) {
-        case RIGHT:
-            colOffset = 1;
-            break;
-        case DOWN:
-            rowOffset = 1;
-            break;
-        case LEFT:
-            colOffset = -1;
-            break;
-        case UP:
-            rowOffset = -1;
-            break;
+    // The directions a beam leaves a tile in, given the direction it came in.
+    static int getExits(char tile, Direction direction, std::array<Direction, 2>& exits) {
+        bool horizontal = direction == LEFT || direction == RIGHT;
+        switch (tile) {
+            case '|':
+                if (horizontal) {
+                    exits = { UP, DOWN };
+                    return 2;
+                }
+                break;
+            case '-':
+                if (!horizontal) {
+                    exits = { LEFT, RIGHT };
+                    return 2;
+                }
+                break;
+            case '/':
+                exits[0] = direction == RIGHT ? UP : direction == UP ? RIGHT : direction == DOWN ? LEFT : DOWN;
+                return 1;
+            case '\\':
+                exits[0] = direction == RIGHT ? DOWN : direction == DOWN ? RIGHT : direction == LEFT ? UP : LEFT;
+                return 1;
+        }
+        exits[0] = direction;
+        return 1;
     }
 
-    char tile = input[rowIndex][colIndex];
-    switch (tile) {
-        case '.':
-            travel(rowIndex + rowOffset, colIndex + colOffset, direction, input, energyGrid, history);
-            break;
-        case '|':
-            if (direction == LEFT || direction == RIGHT) {
-                travel(rowIndex - 1, colIndex, UP, input, energyGrid, history);
-                travel(rowIndex + 1, colIndex, DOWN, input, energyGrid, history);
-            }
-            else if (direction == UP || direction == DOWN){
-                travel(rowIndex + rowOffset, colIndex + colOffset, direction, input, energyGrid, history);
-            }
-            break;
-        case '-':
-            if (direction == UP || direction == DOWN) {
-                travel(rowIndex, colIndex - 1, LEFT, input, energyGrid, history);
-                travel(rowIndex, colIndex + 1, RIGHT, input, energyGrid, history);
-            }
-            else if (direction == LEFT || direction == RIGHT){
-                travel(rowIndex + rowOffset, colIndex + colOffset, direction, input, energyGrid, history);
-            }
-            break;
-        case '/':
-            if (direction == UP) {
-                travel(rowIndex, colIndex + 1, RIGHT, input, energyGrid, history);
-            }
-            else if (direction == RIGHT) {
-                travel(rowIndex - 1, colIndex, UP, input, energyGrid, history);
-            }
-            else if (direction == DOWN) {
-                travel(rowIndex, colIndex - 1, LEFT, input, energyGrid, history);
+    // Follows a beam from (row, col), inclusive, until it hits a mirror or
+    // splitter or leaves the grid.
+    Beam followBeam(int row, int col, Direction direction) const {
+        Beam beam = { { row * width + col, direction, 0 }, noState };
+        while (row >= 0 && row < height && col >= 0 && col < width) {
+            int node = nodeIndices[row * width + col];
+            if (node != -1) {
+                beam.state = node * 4 + direction;
+                break;
             }
-            else if (direction == LEFT) {
-                travel(rowIndex + 1, colIndex, DOWN, input, energyGrid, history);
-            }
-            break;
-        case '\\':
-            if (direction == UP) {
-                travel(rowIndex, colIndex - 1, LEFT, input, energyGrid, history);
-            }
-            else if (direction == RIGHT) {
-                travel(rowIndex + 1, colIndex, DOWN, input, energyGrid, history);
+            ++beam.run.length;
+            row += getRowStep(direction);
+            col += getColStep(direction);
+        }
+        return beam;
+    }
+
+    template <class F>
+    void forEachCell(const Run& run, F f) const {
+        int step = getRowStep(run.direction) * width + getColStep(run.direction);
+        for (int i = 0, cell = run.startCell; i < run.length; ++i, cell += step) {
+            f(cell);
+        }
+    }
+
+public:
+    BeamGraph(const std::vector<std::string>& grid) : height(grid.size()), width(grid.empty() ? 0 : grid[0].length()) {
+        wordsPerGrid = (static_cast<size_t>(height) * width + 63) / 64;
+        nodeIndices.assign(static_cast<size_t>(height) * width, -1);
+        for (int row = 0; row < height; ++row) {
+            for (int col = 0; col < width; ++col) {
+                if (grid[row][col] != '.') {
+                    nodeIndices[row * width + col] = nodeCells.size();
+                    nodeCells.push_back(row * width + col);
+                }
             }
-            else if (direction == DOWN) {
-                travel(rowIndex, colIndex + 1, RIGHT, input, energyGrid, history);
+        }
+
+        stateBeams.resize(nodeCells.size() * 4);
+        for (size_t state = 0; state < stateBeams.size(); ++state) {
+            int cell = nodeCells[state / 4];
+            int row = cell / width;
+            int col = cell % width;
+            std::array<Direction, 2> exits;
+            int exitCount = getExits(grid[row][col], static_cast<Direction>(state % 4), exits);
+            for (int exit = 0; exit < 2; ++exit) {
+                stateBeams[state][exit] = exit < exitCount
+                    ? followBeam(row + getRowStep(exits[exit]), col + getColStep(exits[exit]), exits[exit])
+                    : Beam{ { cell, exits[0], 0 }, noState };
             }
-            else if (direction == LEFT) {
-                travel(rowIndex - 1, colIndex, UP, input, energyGrid, history);
+        }
+    }
+
+    // The number of tiles energised by a beam entering the grid at (row, col)
+    // heading in the given direction.
+    int countEnergised(int row, int col, Direction direction) const {
+        Beam start = followBeam(row, col, direction);
+        std::vector<uint64_t> energised(wordsPerGrid, 0);
+        auto mark = [&](int cell) {
+            energised[cell / 64] |= uint64_t(1) << (cell % 64);
+        };
+        forEachCell(start.run, mark);
+
+        // Walk every state the beam can reach.
+        if (start.state != noState) {
+            std::vector<bool> visited(stateBeams.size(), false);
+            std::vector<int> stack = { start.state };
+            visited[start.state] = true;
+            while (!stack.empty()) {
+                int state = stack.back();
+                stack.pop_back();
+                mark(nodeCells[state / 4]);
+                for (const Beam& beam : stateBeams[state]) {
+                    forEachCell(beam.run, mark);
+                    if (beam.state != noState && !visited[beam.state]) {
+                        visited[beam.state] = true;
+                        stack.push_back(beam.state);
+                    }
+                }
             }
-            break;
+        }
+
+        int count = 0;
+        for (uint64_t word : energised) {
+            count += std::popcount(word);
+        }
+        return count;
+    }
+};
+
+int solution(const std::string fileName);
+std::vector<std::string> readLines(const std::string fileName);
+
+int main() {
+    std::cout << std::endl;
+    std::cout << "Example Solution: " << solution("example.txt") << " (expected 46)" << std::endl;
+    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
+    std::cout << std::endl;
+}
+
+int solution(const std::string fileName) {
+    std::vector<std::string> input = readLines(fileName);
+    if (input.empty()) {
+        return 0;
     }
+
+    BeamGraph graph(input);
+    return graph.countEnergised(0, 0, RIGHT);
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
@@ -7,171 +7,408 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <array>
 #include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <atomic>
+#include <thread>
 
 enum Direction { RIGHT, DOWN, LEFT, UP };
 
-int solution(const std::string fileName);
-void travel(const int rowIndex, const int colIndex, const Direction direction, const std::vector<std::string>& input, std::vector<std::vector<char>>& energyGrid, std::vector<std::string>& history);
-int countEnergy(const std::vector<std::vector<char>>& energyGrid);
-std::vector<std::string> readLines(const std::string fileName);
-
-int main() {
-    std::cout << std::endl;
-    std::cout << "Example Solution: " << solution("example.txt") << " (expected 51)" << std::endl;
-    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
-    std::cout << std::endl;
-}
-
-int solution(const std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
+// A worker's scratch space for walking the graph, reused for every beam it
+// follows. Instead of clearing it between beams, each word of the energised
+// bitset and each visited state is stamped with the generation it was last
+// written in, and anything stamped with an older generation counts as empty.
+class BeamScratch {
+private:
+    uint32_t generation = 0;
+    std::vector<uint64_t> words;
+    std::vector<uint32_t> wordGenerations;
+    std::vector<uint32_t> stateGenerations;
+    int energisedCount = 0;
 
-    int maxTotal = 0;
+public:
+    BeamScratch(size_t wordCount, size_t stateCount) : words(wordCount, 0), wordGenerations(wordCount, 0), stateGenerations(stateCount, 0) {}
 
-    // Top Row
-    for (int i = 0; i < input[0].length(); ++i) {
-        std::vector<std::vector<char>> energyGrid = std::vector<std::vector<char>>(input.size(), std::vector<char>(input[0].length(), '.'));
-        std::vector<std::string> history;
-        travel(0, i, DOWN, input, energyGrid, history);
-        int total = countEnergy(energyGrid);
-        if (total > maxTotal) {
-            maxTotal = total;
+    void reset() {
+        ++generation;
+        if (generation == 0) {
+            std::fill(wordGenerations.begin(), wordGenerations.end(), 0);
+            std::fill(stateGenerations.begin(), stateGenerations.end(), 0);
+            generation = 1;
         }
+        energisedCount = 0;
     }
 
-    // Bottom Row
-    for (int i = 0; i < input[0].length(); ++i) {
-        std::vector<std::vector<char>> energyGrid = std::vector<std::vector<char>>(input.size(), std::vector<char>(input[0].length(), '.'));
-        std::vector<std::string> history;
-        travel(input.size() - 1, i, UP, input, energyGrid, history);
-        int total = countEnergy(energyGrid);
-        if (total > maxTotal) {
-            maxTotal = total;
+    void mark(int cell) {
+        size_t word = cell / 64;
+        if (wordGenerations[word] != generation) {
+            wordGenerations[word] = generation;
+            words[word] = 0;
+        }
+        uint64_t bit = uint64_t(1) << (cell % 64);
+        if ((words[word] & bit) == 0) {
+            words[word] |= bit;
+            ++energisedCount;
         }
     }
 
-    // Left Column
-    for (int i = 0; i < input.size(); ++i) {
-        std::vector<std::vector<char>> energyGrid = std::vector<std::vector<char>>(input.size(), std::vector<char>(input[0].length(), '.'));
-        std::vector<std::string> history;
-        travel(i, 0, RIGHT, input, energyGrid, history);
-        int total = countEnergy(energyGrid);
-        if (total > maxTotal) {
-            maxTotal = total;
+    // Returns false if the state was already visited in this generation.
+    bool visit(int state) {
+        if (stateGenerations[state] == generation) {
+            return false;
         }
+        stateGenerations[state] = generation;
+        return true;
     }
 
-    // Right Column
-    for (int i = 0; i < input.size(); ++i) {
-        std::vector<std::vector<char>> energyGrid = std::vector<std::vector<char>>(input.size(), std::vector<char>(input[0].length(), '.'));
-        std::vector<std::string> history;
-        travel(i, input[0].length() - 1, LEFT, input, energyGrid, history);
-        int total = countEnergy(energyGrid);
-        if (total > maxTotal) {
-            maxTotal = total;
-        }
+    int getEnergisedCount() const {
+        return energisedCount;
     }
+};
 
-    return maxTotal;
-}
+// The contraption as a graph. A state is a beam entering one of the mirrors
+// or splitters in a given direction. Leaving it, the beam goes straight along
+// a run of empty tiles until it reaches the next state or the edge of the
+// grid. Loops of states are condensed into strongly connected components,
+// and every component gets a bitset of all the tiles a beam energises from
+// there on, so any beam is answered by looking up where it first lands.
+class BeamGraph {
+private:
+    // Empty tiles in a straight line, not including the tile the run ends at.
+    struct Run {
+        int startCell;
+        Direction direction;
+        int length;
+    };
+
+    // Where a beam goes: the run it travels along first, then the state it
+    // arrives at, or -1 if it leaves the grid.
+    struct Beam {
+        Run run;
+        int state;
+    };
+
+    static const int noState = -1;
+    static const size_t maxBitsetWords = size_t(1) << 24;
 
-void travel(const int rowIndex, const int colIndex, const Direction direction, const std::vector<std::string>& input, std::vector<std::vector<char>>& energyGrid, std::vector<std::string>& history) {
-    if (rowIndex < 0 || rowIndex >= input.size() || colIndex < 0 || colIndex >= input[0].length()) {
-        return;
+    int height;
+    int width;
+    size_t wordsPerGrid;
+    std::vector<int> nodeCells;
+    std::vector<int> nodeIndices;
+    std::vector<std::array<Beam, 2>> stateBeams;
+    std::vector<int> stateComponents;
+    std::vector<std::vector<int>> componentStates;
+    std::vector<uint64_t> reachable;
+    std::vector<int> reachableCounts;
+
+    static int getRowStep(Direction direction) {
+        return direction == DOWN ? 1 : direction == UP ? -1 : 0;
     }
 
-    char tile = input[rowIndex][colIndex];
+    static int getColStep(Direction direction) {
+        return direction == RIGHT ? 1 : direction == LEFT ? -1 : 0;
+    }
 
-    if (tile != '.') {
-        std::string historyString = std::to_string(rowIndex) + " " + std::to_string(colIndex) + " " + std::to_string(direction);
-        if (std::find(history.begin(), history.end(), historyString) != history.end()) {
-            return;
+    // The directions a beam leaves a tile in, given the direction it came in.
+    static int getExits(char tile, Direction direction, std::array<Direction, 2>& exits) {
+        bool horizontal = direction == LEFT || direction == RIGHT;
+        switch (tile) {
+            case '|':
+                if (horizontal) {
+                    exits = { UP, DOWN };
+                    return 2;
+                }
+                break;
+            case '-':
+                if (!horizontal) {
+                    exits = { LEFT, RIGHT };
+                    return 2;
+                }
+                break;
+            case '/':
+                exits[0] = direction == RIGHT ? UP : direction == UP ? RIGHT : direction == DOWN ? LEFT : DOWN;
+                return 1;
+            case '\\':
+                exits[0] = direction == RIGHT ? DOWN : direction == DOWN ? RIGHT : direction == LEFT ? UP : LEFT;
+                return 1;
         }
-        history.push_back(historyString);
+        exits[0] = direction;
+        return 1;
     }
 
-    energyGrid[rowIndex][colIndex] = '#';
+    // Follows a beam from (row, col), inclusive, until it hits a mirror or
+    // splitter or leaves the grid.
+    Beam followBeam(int row, int col, Direction direction) const {
+        Beam beam = { { row * width + col, direction, 0 }, noState };
+        while (row >= 0 && row < height && col >= 0 && col < width) {
+            int node = nodeIndices[row * width + col];
+            if (node != -1) {
+                beam.state = node * 4 + direction;
+                break;
+            }
+            ++beam.run.length;
+            row += getRowStep(direction);
+            col += getColStep(direction);
+        }
+        return beam;
+    }
 
-    int rowOffset = 0;
-    int colOffset = 0;
-    switch (direction) {
-        case RIGHT:
-            colOffset = 1;
-            break;
-        case DOWN:
-            rowOffset = 1;
-            break;
-        case LEFT:
-            colOffset = -1;
-            break;
-        case UP:
-            rowOffset = -1;
-            break;
+    template <class F>
+    void forEachCell(const Run& run, F f) const {
+        int step = getRowStep(run.direction) * width + getColStep(run.direction);
+        for (int i = 0, cell = run.startCell; i < run.length; ++i, cell += step) {
+            f(cell);
+        }
     }
 
-    switch (tile) {
-        case '.':
-            travel(rowIndex + rowOffset, colIndex + colOffset, direction, input, energyGrid, history);
-            break;
-        case '|':
-            if (direction == LEFT || direction == RIGHT) {
-                travel(rowIndex - 1, colIndex, UP, input, energyGrid, history);
-                travel(rowIndex + 1, colIndex, DOWN, input, energyGrid, history);
-            }
-            else if (direction == UP || direction == DOWN){
-                travel(rowIndex + rowOffset, colIndex + colOffset, direction, input, energyGrid, history);
-            }
-            break;
-        case '-':
-            if (direction == UP || direction == DOWN) {
-                travel(rowIndex, colIndex - 1, LEFT, input, energyGrid, history);
-                travel(rowIndex, colIndex + 1, RIGHT, input, energyGrid, history);
-            }
-            else if (direction == LEFT || direction == RIGHT){
-                travel(rowIndex + rowOffset, colIndex + colOffset, direction, input, energyGrid, history);
-            }
-            break;
-        case '/':
-            if (direction == UP) {
-                travel(rowIndex, colIndex + 1, RIGHT, input, energyGrid, history);
-            }
-            else if (direction == RIGHT) {
-                travel(rowIndex - 1, colIndex, UP, input, energyGrid, history);
+    // Tarjan's algorithm without recursion. Components are numbered in the
+    // order they're completed, so each one only leads to lower numbered ones.
+    void findComponents() {
+        const int stateCount = stateBeams.size();
+        std::vector<int> indices(stateCount, -1);
+        std::vector<int> lowLinks(stateCount, 0);
+        std::vector<bool> onStack(stateCount, false);
+        std::vector<int> stack;
+        std::vector<std::pair<int, int>> callStack;
+        stateComponents.assign(stateCount, -1);
+        int nextIndex = 0;
+
+        for (int root = 0; root < stateCount; ++root) {
+            if (indices[root] != -1) {
+                continue;
             }
-            else if (direction == DOWN) {
-                travel(rowIndex, colIndex - 1, LEFT, input, energyGrid, history);
+            callStack.push_back({ root, 0 });
+            indices[root] = lowLinks[root] = nextIndex++;
+            stack.push_back(root);
+            onStack[root] = true;
+
+            while (!callStack.empty()) {
+                auto& [state, edge] = callStack.back();
+                if (edge < 2) {
+                    int next = stateBeams[state][edge++].state;
+                    if (next == noState) {
+                        continue;
+                    }
+                    if (indices[next] == -1) {
+                        indices[next] = lowLinks[next] = nextIndex++;
+                        stack.push_back(next);
+                        onStack[next] = true;
+                        callStack.push_back({ next, 0 });
+                    }
+                    else if (onStack[next]) {
+                        lowLinks[state] = std::min(lowLinks[state], indices[next]);
+                    }
+                    continue;
+                }
+
+                int finished = state;
+                callStack.pop_back();
+                if (!callStack.empty()) {
+                    int parent = callStack.back().first;
+                    lowLinks[parent] = std::min(lowLinks[parent], lowLinks[finished]);
+                }
+                if (lowLinks[finished] == indices[finished]) {
+                    componentStates.push_back({});
+                    int member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        onStack[member] = false;
+                        stateComponents[member] = componentStates.size() - 1;
+                        componentStates.back().push_back(member);
+                    } while (member != finished);
+                }
             }
-            else if (direction == LEFT) {
-                travel(rowIndex + 1, colIndex, DOWN, input, energyGrid, history);
+        }
+    }
+
+    // A component energises its own tiles and runs, plus everything the
+    // components it leads to energise. Those were all finished first.
+    void buildReachable() {
+        reachable.assign(componentStates.size() * wordsPerGrid, 0);
+        reachableCounts.assign(componentStates.size(), 0);
+        for (size_t component = 0; component < componentStates.size(); ++component) {
+            uint64_t* bits = &reachable[component * wordsPerGrid];
+            auto mark = [&](int cell) {
+                bits[cell / 64] |= uint64_t(1) << (cell % 64);
+            };
+            for (int state : componentStates[component]) {
+                mark(nodeCells[state / 4]);
+                for (const Beam& beam : stateBeams[state]) {
+                    forEachCell(beam.run, mark);
+                    if (beam.state != noState && stateComponents[beam.state] != static_cast<int>(component)) {
+                        const uint64_t* nextBits = &reachable[stateComponents[beam.state] * wordsPerGrid];
+                        for (size_t word = 0; word < wordsPerGrid; ++word) {
+                            bits[word] |= nextBits[word];
+                        }
+                    }
+                }
             }
-            break;
-        case '\\':
-            if (direction == UP) {
-                travel(rowIndex, colIndex - 1, LEFT, input, energyGrid, history);
+            for (size_t word = 0; word < wordsPerGrid; ++word) {
+                reachableCounts[component] += std::popcount(bits[word]);
             }
-            else if (direction == RIGHT) {
-                travel(rowIndex + 1, colIndex, DOWN, input, energyGrid, history);
+        }
+    }
+
+public:
+    BeamGraph(const std::vector<std::string>& grid) : height(grid.size()), width(grid.empty() ? 0 : grid[0].length()) {
+        wordsPerGrid = (static_cast<size_t>(height) * width + 63) / 64;
+        nodeIndices.assign(static_cast<size_t>(height) * width, -1);
+        for (int row = 0; row < height; ++row) {
+            for (int col = 0; col < width; ++col) {
+                if (grid[row][col] != '.') {
+                    nodeIndices[row * width + col] = nodeCells.size();
+                    nodeCells.push_back(row * width + col);
+                }
             }
-            else if (direction == DOWN) {
-                travel(rowIndex, colIndex + 1, RIGHT, input, energyGrid, history);
+        }
+
+        stateBeams.resize(nodeCells.size() * 4);
+        for (size_t state = 0; state < stateBeams.size(); ++state) {
+            int cell = nodeCells[state / 4];
+            int row = cell / width;
+            int col = cell % width;
+            std::array<Direction, 2> exits;
+            int exitCount = getExits(grid[row][col], static_cast<Direction>(state % 4), exits);
+            for (int exit = 0; exit < 2; ++exit) {
+                stateBeams[state][exit] = exit < exitCount
+                    ? followBeam(row + getRowStep(exits[exit]), col + getColStep(exits[exit]), exits[exit])
+                    : Beam{ { cell, exits[0], 0 }, noState };
             }
-            else if (direction == LEFT) {
-                travel(rowIndex - 1, colIndex, UP, input, energyGrid, history);
+        }
+
+        findComponents();
+        if (componentStates.size() * wordsPerGrid <= maxBitsetWords) {
+            buildReachable();
+        }
+    }
+
+    // Only walking the graph needs scratch space, so when every component
+    // has a bitset the scratch is left empty.
+    BeamScratch createScratch() const {
+        return reachable.empty() ? BeamScratch(wordsPerGrid, stateBeams.size()) : BeamScratch(0, 0);
+    }
+
+    // The number of tiles energised by a beam entering the grid at (row, col)
+    // heading in the given direction.
+    int countEnergised(int row, int col, Direction direction, BeamScratch& scratch) const {
+        Beam start = followBeam(row, col, direction);
+        if (start.state == noState) {
+            return start.run.length;
+        }
+
+        // The tiles energised from where the beam lands are already counted,
+        // so only the tiles on the way there that aren't among them are added.
+        if (!reachable.empty()) {
+            int component = stateComponents[start.state];
+            const uint64_t* bits = &reachable[component * wordsPerGrid];
+            int count = reachableCounts[component];
+            forEachCell(start.run, [&](int cell) {
+                count += ((bits[cell / 64] >> (cell % 64)) & 1) == 0;
+            });
+            return count;
+        }
+
+        // Too many components to keep a bitset for each, so walk the states
+        // instead.
+        scratch.reset();
+        auto mark = [&](int cell) {
+            scratch.mark(cell);
+        };
+        forEachCell(start.run, mark);
+        std::vector<int> stack = { start.state };
+        scratch.visit(start.state);
+        while (!stack.empty()) {
+            int state = stack.back();
+            stack.pop_back();
+            mark(nodeCells[state / 4]);
+            for (const Beam& beam : stateBeams[state]) {
+                forEachCell(beam.run, mark);
+                if (beam.state != noState && scratch.visit(beam.state)) {
+                    stack.push_back(beam.state);
+                }
             }
-            break;
+        }
+        return scratch.getEnergisedCount();
     }
+};
+
+// A beam entering the grid, and how many tiles it energises.
+struct BeamStart {
+    int row;
+    int col;
+    Direction direction;
+    int energised;
+};
+
+BeamStart solution(const std::string fileName);
+BeamStart findBestStart(const BeamGraph& graph, int height, int width);
+std::vector<std::string> readLines(const std::string fileName);
+
+int main() {
+    BeamStart example = solution("example.txt");
+    BeamStart input = solution("input.txt");
+
+    std::cout << std::endl;
+    std::cout << "Example Solution: " << example.energised << " (expected 51)" << std::endl;
+    std::cout << "Input Solution: " << input.energised << " (entering at row " << input.row << ", column " << input.col << ")" << std::endl;
+    std::cout << std::endl;
+}
+
+BeamStart solution(const std::string fileName) {
+    std::vector<std::string> input = readLines(fileName);
+    if (input.empty()) {
+        return { 0, 0, RIGHT, 0 };
+    }
+
+    BeamGraph graph(input);
+    return findBestStart(graph, input.size(), input[0].length());
 }
 
-int countEnergy(const std::vector<std::vector<char>>& energyGrid) {
-    int total = 0;
-        for (int i1 = 0; i1 < energyGrid.size(); ++i1) {
-            for (int i2 = 0; i2 < energyGrid[0].size(); ++i2) {
-                if (energyGrid[i1][i2] == '#') {
-                    total += 1;
+// Workers claim the starts along the edges in small batches from a shared
+// counter, each with its own scratch space, and write every count back into
+// its start. Ties go to the earliest start so the answer doesn't depend on
+// scheduling.
+BeamStart findBestStart(const BeamGraph& graph, int height, int width) {
+    std::vector<BeamStart> starts;
+    for (int col = 0; col < width; ++col) {
+        starts.push_back({ 0, col, DOWN, 0 });
+        starts.push_back({ height - 1, col, UP, 0 });
+    }
+    for (int row = 0; row < height; ++row) {
+        starts.push_back({ row, 0, RIGHT, 0 });
+        starts.push_back({ row, width - 1, LEFT, 0 });
+    }
+
+    const size_t batchSize = 16;
+    std::atomic<size_t> nextStart = 0;
+    size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), (starts.size() + batchSize - 1) / batchSize));
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&]() {
+            BeamScratch scratch = graph.createScratch();
+            for (size_t batch = nextStart.fetch_add(batchSize); batch < starts.size(); batch = nextStart.fetch_add(batchSize)) {
+                for (size_t index = batch; index < std::min(batch + batchSize, starts.size()); ++index) {
+                    BeamStart& start = starts[index];
+                    start.energised = graph.countEnergised(start.row, start.col, start.direction, scratch);
                 }
             }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    BeamStart best = starts[0];
+    for (const BeamStart& start : starts) {
+        if (start.energised > best.energised) {
+            best = start;
         }
-    return total;
+    }
+    return best;
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
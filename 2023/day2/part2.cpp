@@ -7,10 +7,23 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <regex>
-#include <numeric>
+#include <algorithm>
+#include <thread>
 
-int solution(std::string fileName);
+// The largest number of each colour seen in any draw of a game, along with the
+// answers both parts need from them.
+struct GameRecord {
+    long long id = 0;
+    int maxRed = 0;
+    int maxGreen = 0;
+    int maxBlue = 0;
+    bool possible = false;
+    long long power = 0;
+};
+
+long long solution(std::string fileName);
+long long sumChunk(const std::vector<std::string>& lines, size_t begin, size_t end);
+GameRecord parseGameRecord(const std::string& line);
 std::vector<std::string> readLines(std::string fileName);
 
 int main() {
@@ -20,35 +33,84 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(std::string fileName) {
+long long solution(std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
 
-    std::vector<std::regex> regexPatterns = {};
-    std::regex redPattern("(\\d+) red", std::regex::icase);
-    regexPatterns.push_back(redPattern);
-    std::regex greenPattern("(\\d+) green", std::regex::icase);
-    regexPatterns.push_back(greenPattern);
-    std::regex bluePattern("(\\d+) blue", std::regex::icase);
-    regexPatterns.push_back(bluePattern);
+    // Split the games into one chunk of lines per thread.
+    size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), input.size()));
+    std::vector<long long> chunkSums(threadCount, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&, i]() {
+            chunkSums[i] = sumChunk(input, input.size() * i / threadCount, input.size() * (i + 1) / threadCount);
+        });
+    }
+    long long counter = 0;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads[i].join();
+        counter += chunkSums[i];
+    }
+
+    return counter;
+}
 
-    int counter = 0;
-    for (std::string line : input) {
-        std::vector<int> minCubeNumbers = {};
-        for (std::regex pattern : regexPatterns) {
-            int largestNumber = 0;
-            std::smatch matches;
-            std::string searchString = line;
-            while(regex_search(searchString, matches, pattern)) {
-                int count = std::stoi(matches[1]);
-                if (count > largestNumber) {largestNumber = count;}
-                searchString = matches.suffix();
-            }
-            minCubeNumbers.push_back(largestNumber);
+long long sumChunk(const std::vector<std::string>& lines, size_t begin, size_t end) {
+    long long sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (!lines[i].empty()) {
+            GameRecord record = parseGameRecord(lines[i]);
+            sum += record.power;
         }
-        counter += std::accumulate(minCubeNumbers.begin(), minCubeNumbers.end(), 1, std::multiplies<int>());
     }
+    return sum;
+}
 
-    return counter;
+// Parses "Game N: 3 blue, 4 red; ..." in a single pass. Only the first letter
+// of each colour is looked at.
+GameRecord parseGameRecord(const std::string& line) {
+    GameRecord record;
+    const char* c = line.data();
+    const char* end = c + line.size();
+
+    // The game ID is the first number on the line.
+    while (c != end && (*c < '0' || *c > '9')) {
+        ++c;
+    }
+    while (c != end && *c >= '0' && *c <= '9') {
+        record.id = record.id * 10 + (*c - '0');
+        ++c;
+    }
+
+    // Every number after that is a count, followed by a space and its colour.
+    while (c != end) {
+        if (*c < '0' || *c > '9') {
+            ++c;
+            continue;
+        }
+        int count = 0;
+        while (c != end && *c >= '0' && *c <= '9') {
+            count = count * 10 + (*c - '0');
+            ++c;
+        }
+        while (c != end && *c == ' ') {
+            ++c;
+        }
+        if (c == end) {
+            break;
+        }
+        switch (*c | 0x20) {
+            case 'r': record.maxRed = std::max(record.maxRed, count); break;
+            case 'g': record.maxGreen = std::max(record.maxGreen, count); break;
+            case 'b': record.maxBlue = std::max(record.maxBlue, count); break;
+        }
+        while (c != end && *c != ',' && *c != ';') {
+            ++c;
+        }
+    }
+
+    record.possible = record.maxRed <= 12 && record.maxGreen <= 13 && record.maxBlue <= 14;
+    record.power = static_cast<long long>(record.maxRed) * record.maxGreen * record.maxBlue;
+    return record;
 }
 
 std::vector<std::string> readLines(std::string fileName) {
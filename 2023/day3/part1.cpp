@@ -8,9 +8,25 @@
 #include <vector>
 #include <fstream>
 #include <cctype>
+#include <algorithm>
+#include <thread>
+#include <functional>
 
-int solution(std::string fileName);
-bool isPartNumber(std::string previousLine, std::string currentLine, std::string nextLine, int startIndex, int endIndex);
+// Every number in the schematic gets a component ID. labels holds, for each
+// cell, the ID of the number covering it (or -1), and values holds the value
+// of each number, parsed exactly once.
+struct LabelledSchematic {
+    size_t height = 0;
+    size_t width = 0;
+    std::vector<int> labels;
+    std::vector<long long> values;
+};
+
+long long solution(std::string fileName);
+LabelledSchematic labelNumbers(const std::vector<std::string>& input, size_t threadCount);
+int collectAdjacentLabels(const LabelledSchematic& schematic, size_t row, size_t col, int* adjacentLabels);
+void forEachBand(size_t rowCount, size_t threadCount, const std::function<void(size_t, size_t, size_t)>& work);
+bool isSymbol(char c);
 std::vector<std::string> readLines(std::string fileName);
 
 int main() {
@@ -20,60 +36,129 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(std::string fileName) {
+long long solution(std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
+    if (input.empty()) {
+        return 0;
+    }
 
-    std::string previousLine;
-    std::string currentLine;
-    std::string nextLine;
-    std::vector<int> partNumbers = {};
-    for (int lineNumber = 0; lineNumber < input.size(); ++lineNumber) {
-        previousLine = (lineNumber - 1 < 0) ? "" : input[lineNumber - 1];
-        currentLine = input[lineNumber];
-        nextLine = (lineNumber + 1 >= input.size()) ? "" : input[lineNumber + 1];
-
-        for (int startIndex = 0; startIndex < currentLine.length(); ++startIndex) {
-            if (std::isdigit(currentLine[startIndex])) {
-                int endIndex = startIndex;
-                while (std::isdigit(currentLine[endIndex+1])) {
-                    endIndex += 1;
-                }
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    LabelledSchematic schematic = labelNumbers(input, threadCount);
 
-                if (isPartNumber(previousLine, currentLine, nextLine, startIndex, endIndex)) {
-                    partNumbers.push_back(std::stoi(currentLine.substr(startIndex, endIndex-startIndex+1)));
+    // Each band collects the labels next to its symbols. A number can touch
+    // symbols in two bands, so the labels are only de-duplicated once all the
+    // bands are done.
+    std::vector<std::vector<int>> bandPartLabels(threadCount);
+    forEachBand(schematic.height, threadCount, [&](size_t band, size_t firstRow, size_t lastRow) {
+        int adjacentLabels[6];
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            for (size_t col = 0; col < input[row].length() && col < schematic.width; ++col) {
+                if (isSymbol(input[row][col])) {
+                    int count = collectAdjacentLabels(schematic, row, col, adjacentLabels);
+                    bandPartLabels[band].insert(bandPartLabels[band].end(), adjacentLabels, adjacentLabels + count);
                 }
-
-                startIndex = endIndex;
             }
         }
+    });
+
+    std::vector<bool> isPartNumber(schematic.values.size(), false);
+    for (const std::vector<int>& partLabels : bandPartLabels) {
+        for (int label : partLabels) {
+            isPartNumber[label] = true;
+        }
     }
 
-    int sum = 0;
-    for (int number : partNumbers) {
-        sum += number;
+    long long sum = 0;
+    for (size_t label = 0; label < schematic.values.size(); ++label) {
+        if (isPartNumber[label]) {
+            sum += schematic.values[label];
+        }
     }
 
     return sum;
 }
 
-bool isPartNumber(std::string previousLine, std::string currentLine, std::string nextLine, int startIndex, int endIndex) {
-    bool foundSymbol = false;
-    for (int i = startIndex - 1; i <= endIndex + 1; ++i) {
-        if (i < 0 || i >= currentLine.length()) {
-            continue;
-        }
+LabelledSchematic labelNumbers(const std::vector<std::string>& input, size_t threadCount) {
+    LabelledSchematic schematic;
+    schematic.height = input.size();
+    schematic.width = input[0].length();
+    schematic.labels.assign(schematic.height * schematic.width, -1);
 
-        if (!previousLine.empty() && previousLine[i] != '.' && !(std::isdigit(previousLine[i]))) {
-            foundSymbol = true;
+    // First count the numbers in each row so that every band knows which IDs
+    // its rows start at.
+    std::vector<size_t> rowOffsets(schematic.height + 1, 0);
+    forEachBand(schematic.height, threadCount, [&](size_t, size_t firstRow, size_t lastRow) {
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            // Rows longer than the first are cut off at its width, in both
+            // passes, so they agree on how many numbers each row has.
+            const std::string& line = input[row];
+            size_t rowWidth = std::min(line.length(), schematic.width);
+            for (size_t col = 0; col < rowWidth; ++col) {
+                if (std::isdigit(line[col]) && (col == 0 || !std::isdigit(line[col - 1]))) {
+                    rowOffsets[row + 1] += 1;
+                }
+            }
         }
-        if (currentLine[i] != '.' && !(std::isdigit(currentLine[i]))) {
-            foundSymbol = true;
+    });
+    for (size_t row = 0; row < schematic.height; ++row) {
+        rowOffsets[row + 1] += rowOffsets[row];
+    }
+    schematic.values.assign(rowOffsets.back(), 0);
+
+    // Then label every digit with its number's ID and parse each value once.
+    forEachBand(schematic.height, threadCount, [&](size_t, size_t firstRow, size_t lastRow) {
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            const std::string& line = input[row];
+            size_t rowWidth = std::min(line.length(), schematic.width);
+            int label = rowOffsets[row];
+            for (size_t col = 0; col < rowWidth; ++col) {
+                if (!std::isdigit(line[col])) {
+                    continue;
+                }
+                long long value = 0;
+                for (; col < rowWidth && std::isdigit(line[col]); ++col) {
+                    value = value * 10 + (line[col] - '0');
+                    schematic.labels[row * schematic.width + col] = label;
+                }
+                schematic.values[label] = value;
+                label += 1;
+            }
         }
-        if (!nextLine.empty() && nextLine[i] != '.' && !(std::isdigit(nextLine[i]))) {
-            foundSymbol = true;
+    });
+
+    return schematic;
+}
+
+// Writes the distinct labels around the given cell into adjacentLabels (which
+// must have room for 6) and returns how many there are.
+int collectAdjacentLabels(const LabelledSchematic& schematic, size_t row, size_t col, int* adjacentLabels) {
+    int count = 0;
+    for (size_t r = (row == 0 ? 0 : row - 1); r <= row + 1 && r < schematic.height; ++r) {
+        for (size_t c = (col == 0 ? 0 : col - 1); c <= col + 1 && c < schematic.width; ++c) {
+            int label = schematic.labels[r * schematic.width + c];
+            if (label != -1 && std::find(adjacentLabels, adjacentLabels + count, label) == adjacentLabels + count) {
+                adjacentLabels[count++] = label;
+            }
         }
     }
-    return foundSymbol;
+    return count;
+}
+
+// Splits the rows into one contiguous band per thread and runs the work on
+// each band in parallel, passing it the band index and its row range.
+void forEachBand(size_t rowCount, size_t threadCount, const std::function<void(size_t, size_t, size_t)>& work) {
+    threadCount = std::max<size_t>(1, std::min(threadCount, rowCount));
+    std::vector<std::thread> threads;
+    for (size_t band = 0; band < threadCount; ++band) {
+        threads.emplace_back(work, band, rowCount * band / threadCount, rowCount * (band + 1) / threadCount);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+bool isSymbol(char c) {
+    return c != '.' && !std::isdigit(c);
 }
 
 std::vector<std::string> readLines(std::string fileName) {
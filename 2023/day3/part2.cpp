@@ -7,10 +7,25 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <regex>
+#include <cctype>
+#include <algorithm>
+#include <thread>
+#include <functional>
 
-int solution(std::string fileName);
-int calculateGearRatio(const std::vector<std::string>* const inputPtr, int lineNumber, int charNumber);
+// Every number in the schematic gets a component ID. labels holds, for each
+// cell, the ID of the number covering it (or -1), and values holds the value
+// of each number, parsed exactly once.
+struct LabelledSchematic {
+    size_t height = 0;
+    size_t width = 0;
+    std::vector<int> labels;
+    std::vector<long long> values;
+};
+
+long long solution(std::string fileName);
+LabelledSchematic labelNumbers(const std::vector<std::string>& input, size_t threadCount);
+int collectAdjacentLabels(const LabelledSchematic& schematic, size_t row, size_t col, int* adjacentLabels);
+void forEachBand(size_t rowCount, size_t threadCount, const std::function<void(size_t, size_t, size_t)>& work);
 std::vector<std::string> readLines(std::string fileName);
 
 int main() {
@@ -20,46 +35,114 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(std::string fileName) {
+long long solution(std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
+    if (input.empty()) {
+        return 0;
+    }
+
+    size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    LabelledSchematic schematic = labelNumbers(input, threadCount);
 
-    int sum = 0;
-    for (int lineNumber = 0; lineNumber < input.size(); ++lineNumber) {
-        for (int charNumber = 0; charNumber < input[lineNumber].length(); ++charNumber) {
-            if (input[lineNumber][charNumber] == '*') {
-                sum += calculateGearRatio(&input, lineNumber, charNumber);
+    // Every gear belongs to exactly one band, so each band can sum its own
+    // gear ratios.
+    std::vector<long long> bandSums(threadCount, 0);
+    forEachBand(schematic.height, threadCount, [&](size_t band, size_t firstRow, size_t lastRow) {
+        int adjacentLabels[6];
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            for (size_t col = 0; col < input[row].length() && col < schematic.width; ++col) {
+                if (input[row][col] == '*' && collectAdjacentLabels(schematic, row, col, adjacentLabels) == 2) {
+                    bandSums[band] += schematic.values[adjacentLabels[0]] * schematic.values[adjacentLabels[1]];
+                }
             }
         }
+    });
+
+    long long sum = 0;
+    for (long long bandSum : bandSums) {
+        sum += bandSum;
     }
 
     return sum;
 }
 
-int calculateGearRatio(const std::vector<std::string>* const inputPtr, int lineNumber, int charNumber) {
-    std::vector<int> adjacentNumbers = {};
-    std::regex pattern("\\d+");
-    for (int i = -1; i <= 1; ++i) {
-        if (lineNumber + i >= 0 && lineNumber + i < (*inputPtr).size()) {
-            std::string line = (*inputPtr)[lineNumber + i];
-            std::sregex_iterator iterator(line.begin(), line.end(), pattern);
-            std::sregex_iterator end;
-            for (; iterator != end; ++iterator) {
-                std::smatch match = *iterator;
-                int startIndex = match.position();
-                int endIndex = startIndex + match.length() - 1;
-                if (charNumber >= startIndex - 1 && charNumber <= endIndex + 1) {
-                    adjacentNumbers.push_back(std::stoi(match[0]));
+LabelledSchematic labelNumbers(const std::vector<std::string>& input, size_t threadCount) {
+    LabelledSchematic schematic;
+    schematic.height = input.size();
+    schematic.width = input[0].length();
+    schematic.labels.assign(schematic.height * schematic.width, -1);
+
+    // First count the numbers in each row so that every band knows which IDs
+    // its rows start at.
+    std::vector<size_t> rowOffsets(schematic.height + 1, 0);
+    forEachBand(schematic.height, threadCount, [&](size_t, size_t firstRow, size_t lastRow) {
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            // Rows longer than the first are cut off at its width, in both
+            // passes, so they agree on how many numbers each row has.
+            const std::string& line = input[row];
+            size_t rowWidth = std::min(line.length(), schematic.width);
+            for (size_t col = 0; col < rowWidth; ++col) {
+                if (std::isdigit(line[col]) && (col == 0 || !std::isdigit(line[col - 1]))) {
+                    rowOffsets[row + 1] += 1;
                 }
             }
         }
+    });
+    for (size_t row = 0; row < schematic.height; ++row) {
+        rowOffsets[row + 1] += rowOffsets[row];
     }
+    schematic.values.assign(rowOffsets.back(), 0);
+
+    // Then label every digit with its number's ID and parse each value once.
+    forEachBand(schematic.height, threadCount, [&](size_t, size_t firstRow, size_t lastRow) {
+        for (size_t row = firstRow; row < lastRow; ++row) {
+            const std::string& line = input[row];
+            size_t rowWidth = std::min(line.length(), schematic.width);
+            int label = rowOffsets[row];
+            for (size_t col = 0; col < rowWidth; ++col) {
+                if (!std::isdigit(line[col])) {
+                    continue;
+                }
+                long long value = 0;
+                for (; col < rowWidth && std::isdigit(line[col]); ++col) {
+                    value = value * 10 + (line[col] - '0');
+                    schematic.labels[row * schematic.width + col] = label;
+                }
+                schematic.values[label] = value;
+                label += 1;
+            }
+        }
+    });
 
-    int gearRatio = 0;
-    if (adjacentNumbers.size() == 2) {
-        gearRatio += adjacentNumbers[0] * adjacentNumbers[1];
+    return schematic;
+}
+
+// Writes the distinct labels around the given cell into adjacentLabels (which
+// must have room for 6) and returns how many there are.
+int collectAdjacentLabels(const LabelledSchematic& schematic, size_t row, size_t col, int* adjacentLabels) {
+    int count = 0;
+    for (size_t r = (row == 0 ? 0 : row - 1); r <= row + 1 && r < schematic.height; ++r) {
+        for (size_t c = (col == 0 ? 0 : col - 1); c <= col + 1 && c < schematic.width; ++c) {
+            int label = schematic.labels[r * schematic.width + c];
+            if (label != -1 && std::find(adjacentLabels, adjacentLabels + count, label) == adjacentLabels + count) {
+                adjacentLabels[count++] = label;
+            }
+        }
     }
+    return count;
+}
 
-    return gearRatio;
+// Splits the rows into one contiguous band per thread and runs the work on
+// each band in parallel, passing it the band index and its row range.
+void forEachBand(size_t rowCount, size_t threadCount, const std::function<void(size_t, size_t, size_t)>& work) {
+    threadCount = std::max<size_t>(1, std::min(threadCount, rowCount));
+    std::vector<std::thread> threads;
+    for (size_t band = 0; band < threadCount; ++band) {
+        threads.emplace_back(work, band, rowCount * band / threadCount, rowCount * (band + 1) / threadCount);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
 }
 
 std::vector<std::string> readLines(std::string fileName) {
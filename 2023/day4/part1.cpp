@@ -7,10 +7,14 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <regex>
+#include <bitset>
 
-int solution(std::string fileName);
-std::vector<std::string> readLines(std::string fileName);
+// Every number on a card is below 100, so each side of a card fits in one
+// 128-bit mask and the matches are the bits the two sides share.
+typedef std::bitset<128> NumberMask;
+
+long long solution(std::string fileName);
+int countMatches(const std::string& line);
 
 int main() {
     std::cout << std::endl;
@@ -19,52 +23,52 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
-
-    int sum = 0;
-    std::regex pattern("\\d+");
-    for (std::string line : input) {
-        int value = 0;
-        int colonIndex = line.find(':');
-        int pipeIndex = line.find('|');
-        std::string myNumbers = line.substr(colonIndex + 1, pipeIndex - (colonIndex + 1));
-        std::string winningNumbers = line.substr(pipeIndex + 1);
-
-        std::sregex_iterator iterator1(myNumbers.begin(), myNumbers.end(), pattern);
-        std::sregex_iterator end;
-        for (; iterator1 != end; ++iterator1) {
-            std::smatch match1 = *iterator1;
-
-            std::sregex_iterator iterator2(winningNumbers.begin(), winningNumbers.end(), pattern);
-            for (; iterator2 != end; ++iterator2) {
-                std::smatch match2 = *iterator2;
+long long solution(std::string fileName) {
+    std::ifstream inputFile(fileName);
+    if (inputFile.fail()) {
+        std::cout << "The file doesn't exist you dummy!" << std::endl;
+        return 0;
+    }
 
-                if (match1[0] == match2[0]) {
-                    value = (value == 0) ? 1 : value * 2;
-                }
-            }
+    long long sum = 0;
+    std::string line;
+    while (std::getline(inputFile, line)) {
+        int numOfMatches = countMatches(line);
+        if (numOfMatches > 0) {
+            sum += 1LL << (numOfMatches - 1);
         }
-        sum += value;
     }
 
     return sum;
 }
 
-std::vector<std::string> readLines(std::string fileName) {
-    std::vector<std::string> lines;
-    std::ifstream inputFile(fileName);
+int countMatches(const std::string& line) {
+    NumberMask myNumbers;
+    NumberMask winningNumbers;
+    NumberMask* currentMask = nullptr;
 
-    if (inputFile.fail()) {
-        std::cout << "The file doesn't exist you dummy!" << std::endl;
-    }
-    else {
-        std::string line;
-        while (std::getline(inputFile, line)) {
-            lines.push_back(line);
+    // Nothing before the colon is a card number, and everything after the
+    // pipe is a winning number.
+    int number = -1;
+    for (char c : line) {
+        if (c >= '0' && c <= '9') {
+            number = (number == -1 ? 0 : number * 10) + (c - '0');
+            continue;
         }
-        inputFile.close();
+        if (number != -1 && currentMask != nullptr) {
+            currentMask->set(number);
+        }
+        number = -1;
+        if (c == ':') {
+            currentMask = &myNumbers;
+        }
+        else if (c == '|') {
+            currentMask = &winningNumbers;
+        }
+    }
+    if (number != -1 && currentMask != nullptr) {
+        currentMask->set(number);
     }
 
-    return lines;
+    return (myNumbers & winningNumbers).count();
 }
@@ -7,11 +7,14 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <regex>
-#include <numeric>
+#include <bitset>
 
-int solution(std::string fileName);
-std::vector<std::string> readLines(std::string fileName);
+// Every number on a card is below 100, so each side of a card fits in one
+// 128-bit mask and the matches are the bits the two sides share.
+typedef std::bitset<128> NumberMask;
+
+long long solution(std::string fileName);
+int countMatches(const std::string& line);
 
 int main() {
     std::cout << std::endl;
@@ -20,56 +23,73 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
-
-    std::vector<int> cardCopies(input.size(), 1);
-    std::regex pattern("\\d+");
-    for (int lineNumber = 0; lineNumber < input.size(); ++lineNumber) {
-        std::string line = input[lineNumber];
-        int numOfMatches = 0;
-        int colonIndex = line.find(':');
-        int pipeIndex = line.find('|');
-        std::string myNumbers = line.substr(colonIndex + 1, pipeIndex - (colonIndex + 1));
-        std::string winningNumbers = line.substr(pipeIndex + 1);
-
-        std::sregex_iterator iterator1(myNumbers.begin(), myNumbers.end(), pattern);
-        std::sregex_iterator end;
-        for (; iterator1 != end; ++iterator1) {
-            std::smatch match1 = *iterator1;
+long long solution(std::string fileName) {
+    std::ifstream inputFile(fileName);
+    if (inputFile.fail()) {
+        std::cout << "The file doesn't exist you dummy!" << std::endl;
+        return 0;
+    }
 
-            std::sregex_iterator iterator2(winningNumbers.begin(), winningNumbers.end(), pattern);
-            for (; iterator2 != end; ++iterator2) {
-                std::smatch match2 = *iterator2;
+    // A card can win at most one copy of each of the next 128 cards, so a
+    // difference array over a window of that size is enough to know how many
+    // copies of each card there are as the cards stream past.
+    const int windowSize = NumberMask().size() + 1;
+    std::vector<long long> copyDeltas(windowSize, 0);
+    long long copiesOfCurrentCard = 1;
+    long long totalCards = 0;
 
-                if (match1[0] == match2[0]) {
-                    numOfMatches += 1;
-                }
-            }
+    // Blank lines aren't cards, so they don't take a slot in the window.
+    std::string line;
+    long long cardIndex = 0;
+    while (std::getline(inputFile, line)) {
+        if (line.empty()) {
+            continue;
         }
+        int slot = cardIndex % windowSize;
+        copiesOfCurrentCard += copyDeltas[slot];
+        copyDeltas[slot] = 0;
+        totalCards += copiesOfCurrentCard;
 
-        for (int i = 1 ; i <= numOfMatches; ++i) {
-            cardCopies[lineNumber + i] += cardCopies[lineNumber];
+        // Every copy of this card wins one copy of each of the next
+        // numOfMatches cards.
+        int numOfMatches = countMatches(line);
+        if (numOfMatches > 0) {
+            copyDeltas[(cardIndex + 1) % windowSize] += copiesOfCurrentCard;
+            copyDeltas[(cardIndex + numOfMatches + 1) % windowSize] -= copiesOfCurrentCard;
         }
+        ++cardIndex;
     }
 
-    return std::accumulate(cardCopies.begin(), cardCopies.end(), 0);
+    return totalCards;
 }
 
-std::vector<std::string> readLines(std::string fileName) {
-    std::vector<std::string> lines;
-    std::ifstream inputFile(fileName);
+int countMatches(const std::string& line) {
+    NumberMask myNumbers;
+    NumberMask winningNumbers;
+    NumberMask* currentMask = nullptr;
 
-    if (inputFile.fail()) {
-        std::cout << "The file doesn't exist you dummy!" << std::endl;
-    }
-    else {
-        std::string line;
-        while (std::getline(inputFile, line)) {
-            lines.push_back(line);
+    // Nothing before the colon is a card number, and everything after the
+    // pipe is a winning number.
+    int number = -1;
+    for (char c : line) {
+        if (c >= '0' && c <= '9') {
+            number = (number == -1 ? 0 : number * 10) + (c - '0');
+            continue;
+        }
+        if (number != -1 && currentMask != nullptr) {
+            currentMask->set(number);
         }
-        inputFile.close();
+        number = -1;
+        if (c == ':') {
+            currentMask = &myNumbers;
+        }
+        else if (c == '|') {
+            currentMask = &winningNumbers;
+        }
+    }
+    if (number != -1 && currentMask != nullptr) {
+        currentMask->set(number);
     }
 
-    return lines;
+    return (myNumbers & winningNumbers).count();
 }
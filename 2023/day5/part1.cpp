@@ -9,29 +9,107 @@
 #include <fstream>
 #include <regex>
 #include <tuple>
-
+#include <algorithm>
+#include <limits>
+
+// A piecewise-linear function over the whole of long long, stored as sorted
+// segment starts with an offset for each segment. Within segment i, which
+// runs from segmentStarts[i] up to the next start, f(x) = x + offsets[i].
+// Mappings are collected with addRangeMapping and sorted once by finalise.
+// Maps can then be composed, so the seven almanac maps collapse into one
+// lookup.
 class RangeMap {
 private:
     std::vector<std::tuple<long long, long long, long long>> rangeMappings = {};
+    std::vector<long long> segmentStarts = {std::numeric_limits<long long>::min()};
+    std::vector<long long> offsets = {0};
+
+    size_t findSegment(long long key) const {
+        return std::upper_bound(segmentStarts.begin(), segmentStarts.end(), key) - segmentStarts.begin() - 1;
+    }
+
+    long long segmentEnd(size_t segment) const {
+        return (segment + 1 < segmentStarts.size()) ? segmentStarts[segment + 1] : std::numeric_limits<long long>::max();
+    }
+
+    // Appends a segment, merging it into the previous one when the offsets
+    // match.
+    void addSegment(long long start, long long offset) {
+        if (!offsets.empty() && offsets.back() == offset) {
+            return;
+        }
+        if (!segmentStarts.empty() && segmentStarts.back() == start) {
+            offsets.back() = offset;
+            return;
+        }
+        segmentStarts.push_back(start);
+        offsets.push_back(offset);
+    }
 
 public:
     void addRangeMapping(long long sourceStart, long long destinationStart, long long rangeLength) {
         rangeMappings.push_back(std::tuple<long long, long long, long long>(sourceStart, destinationStart, rangeLength));
     }
 
-    long long getValue(long long key) {
-        long long value = key;
+    // Sorts the mappings once and turns them into segments, with identity
+    // segments filling the gaps.
+    void finalise() {
+        std::sort(rangeMappings.begin(), rangeMappings.end());
+        segmentStarts.clear();
+        offsets.clear();
+        long long previousEnd = std::numeric_limits<long long>::min();
         for (std::tuple<long long, long long, long long> rangeMapping : rangeMappings) {
             long long sourceStart = std::get<0>(rangeMapping);
             long long destinationStart = std::get<1>(rangeMapping);
             long long rangeLength = std::get<2>(rangeMapping);
-            if (key >= sourceStart && key < sourceStart + rangeLength) {
-                long long offset = key - sourceStart;
-                value = destinationStart + offset;
-                break;
+            if (sourceStart > previousEnd || segmentStarts.empty()) {
+                addSegment(previousEnd, 0);
             }
+            addSegment(sourceStart, destinationStart - sourceStart);
+            previousEnd = sourceStart + rangeLength;
+        }
+        addSegment(previousEnd, 0);
+    }
+
+    long long getValue(long long key) const {
+        return key + offsets[findSegment(key)];
+    }
+
+    // Returns the map that applies this one and then next.
+    RangeMap then(const RangeMap& next) const {
+        RangeMap composed;
+        composed.segmentStarts.clear();
+        composed.offsets.clear();
+        for (size_t segment = 0; segment < segmentStarts.size(); ++segment) {
+            long long offset = offsets[segment];
+            long long end = segmentEnd(segment);
+            // Split this segment wherever its image crosses one of next's
+            // segment boundaries.
+            for (long long start = segmentStarts[segment]; start < end;) {
+                size_t nextSegment = next.findSegment(start + offset);
+                long long nextEnd = next.segmentEnd(nextSegment);
+                long long pieceEnd = (nextEnd == std::numeric_limits<long long>::max()) ? end : std::min(end, nextEnd - offset);
+                composed.addSegment(start, offset + next.offsets[nextSegment]);
+                start = pieceEnd;
+            }
+        }
+        return composed;
+    }
+
+    // Maps a whole batch of keys. The segment search is branch-free (a fixed
+    // number of halving steps with a conditional move), so the loop has no
+    // data-dependent branches for the compiler to trip over.
+    void getValues(const long long* keys, long long* values, size_t count) const {
+        const long long* starts = segmentStarts.data();
+        size_t segmentCount = segmentStarts.size();
+        for (size_t i = 0; i < count; ++i) {
+            long long key = keys[i];
+            const long long* base = starts;
+            for (size_t length = segmentCount; length > 1; length -= length / 2) {
+                base = (base[length / 2] <= key) ? base + length / 2 : base;
+            }
+            values[i] = key + offsets[base - starts];
         }
-        return value;
     }
 };
 
@@ -62,15 +140,14 @@ long long solution(std::string fileName) {
     rangeMaps.push_back(getMap(&input, "temperature-to-humidity map:"));
     rangeMaps.push_back(getMap(&input, "humidity-to-location map:"));
 
-    std::vector<long long> locations = {};
-    for (long long seed : seeds) {
-        long long destination = seed;
-        for (RangeMap rangeMap : rangeMaps) {
-            destination = rangeMap.getValue(destination);
-        }
-        locations.push_back(destination);
+    RangeMap seedToLocation = rangeMaps[0];
+    for (size_t i = 1; i < rangeMaps.size(); ++i) {
+        seedToLocation = seedToLocation.then(rangeMaps[i]);
     }
 
+    std::vector<long long> locations(seeds.size());
+    seedToLocation.getValues(seeds.data(), locations.data(), seeds.size());
+
     return *(std::min_element(locations.begin(), locations.end()));
 }
 
@@ -107,6 +184,7 @@ RangeMap getMap(std::vector<std::string>* inputPtr, std::string mapName) {
             break;
         }
     }
+    rangeMap.finalise();
     return rangeMap;
 }
 
@@ -9,60 +9,108 @@
 #include <fstream>
 #include <regex>
 #include <tuple>
-
+#include <algorithm>
+#include <limits>
+
+// A piecewise-linear function over the whole of long long, stored as sorted
+// segment starts with an offset for each segment. Within segment i, which
+// runs from segmentStarts[i] up to the next start, f(x) = x + offsets[i].
+// Mappings are collected with addRangeMapping and sorted once by finalise.
+// Maps can then be composed, so the seven almanac maps collapse into one
+// lookup.
 class RangeMap {
 private:
     std::vector<std::tuple<long long, long long, long long>> rangeMappings = {};
+    std::vector<long long> segmentStarts = {std::numeric_limits<long long>::min()};
+    std::vector<long long> offsets = {0};
+
+    size_t findSegment(long long key) const {
+        return std::upper_bound(segmentStarts.begin(), segmentStarts.end(), key) - segmentStarts.begin() - 1;
+    }
+
+    long long segmentEnd(size_t segment) const {
+        return (segment + 1 < segmentStarts.size()) ? segmentStarts[segment + 1] : std::numeric_limits<long long>::max();
+    }
+
+    // Appends a segment, merging it into the previous one when the offsets
+    // match.
+    void addSegment(long long start, long long offset) {
+        if (!offsets.empty() && offsets.back() == offset) {
+            return;
+        }
+        if (!segmentStarts.empty() && segmentStarts.back() == start) {
+            offsets.back() = offset;
+            return;
+        }
+        segmentStarts.push_back(start);
+        offsets.push_back(offset);
+    }
 
 public:
     void addRangeMapping(long long sourceStart, long long destinationStart, long long rangeLength) {
         rangeMappings.push_back(std::tuple<long long, long long, long long>(sourceStart, destinationStart, rangeLength));
-        std::sort(rangeMappings.begin(), rangeMappings.end());
     }
 
-    long long getValue(long long key) {
-        long long value = key;
+    // Sorts the mappings once and turns them into segments, with identity
+    // segments filling the gaps.
+    void finalise() {
+        std::sort(rangeMappings.begin(), rangeMappings.end());
+        segmentStarts.clear();
+        offsets.clear();
+        long long previousEnd = std::numeric_limits<long long>::min();
         for (std::tuple<long long, long long, long long> rangeMapping : rangeMappings) {
             long long sourceStart = std::get<0>(rangeMapping);
             long long destinationStart = std::get<1>(rangeMapping);
             long long rangeLength = std::get<2>(rangeMapping);
-            if (key >= sourceStart && key < sourceStart + rangeLength) {
-                long long offset = key - sourceStart;
-                value = destinationStart + offset;
-                break;
+            if (sourceStart > previousEnd || segmentStarts.empty()) {
+                addSegment(previousEnd, 0);
             }
+            addSegment(sourceStart, destinationStart - sourceStart);
+            previousEnd = sourceStart + rangeLength;
         }
-        return value;
+        addSegment(previousEnd, 0);
     }
 
-    long long findSourceOverlapPoint(long long rangeStart, long long rangeLength) {
-        long long rangeEnd = rangeStart + rangeLength - 1;
-        long long overlapPoint = rangeEnd;
-        for (std::tuple<long long, long long, long long> rangeMapping : rangeMappings) {
-            long long mappingSourceStart = std::get<0>(rangeMapping);
-            long long mappingRangeLength = std::get<2>(rangeMapping);
-            long long mappingSourceEnd = mappingSourceStart + mappingRangeLength - 1;
-            // Check if range overlaps the current mapping range.
-            if (rangeStart >= mappingSourceStart && rangeStart <= mappingSourceEnd) {
-                // Head overlap found, set overlap point to mapping source end
-                // or range end depending on whats smaller.
-                overlapPoint = std::min(mappingSourceEnd, rangeEnd);
-                break;
-            }
-            else if (rangeStart < mappingSourceStart && rangeEnd >= mappingSourceStart) {
-                // Tail overlap found, set overlap point to mapping range start - 1.
-                overlapPoint = mappingSourceStart - 1;
-                break;
+    long long getValue(long long key) const {
+        return key + offsets[findSegment(key)];
+    }
+
+    // Returns the map that applies this one and then next.
+    RangeMap then(const RangeMap& next) const {
+        RangeMap composed;
+        composed.segmentStarts.clear();
+        composed.offsets.clear();
+        for (size_t segment = 0; segment < segmentStarts.size(); ++segment) {
+            long long offset = offsets[segment];
+            long long end = segmentEnd(segment);
+            // Split this segment wherever its image crosses one of next's
+            // segment boundaries.
+            for (long long start = segmentStarts[segment]; start < end;) {
+                size_t nextSegment = next.findSegment(start + offset);
+                long long nextEnd = next.segmentEnd(nextSegment);
+                long long pieceEnd = (nextEnd == std::numeric_limits<long long>::max()) ? end : std::min(end, nextEnd - offset);
+                composed.addSegment(start, offset + next.offsets[nextSegment]);
+                start = pieceEnd;
             }
         }
-        return overlapPoint;
+        return composed;
+    }
+
+    // Maps a range of keys to the ranges of values they cover, one per
+    // segment the range passes through.
+    void getValueRanges(long long rangeStart, long long rangeLength, std::vector<std::pair<long long, long long>>& valueRanges) const {
+        long long rangeEnd = rangeStart + rangeLength;
+        for (size_t segment = findSegment(rangeStart); rangeStart < rangeEnd; ++segment) {
+            long long pieceEnd = std::min(rangeEnd, segmentEnd(segment));
+            valueRanges.push_back(std::pair<long long, long long>(rangeStart + offsets[segment], pieceEnd - rangeStart));
+            rangeStart = pieceEnd;
+        }
     }
 };
 
 long long solution(std::string fileName);
 std::vector<std::pair<long long, long long>> getSeedRanges(std::string line);
 RangeMap getMap(std::vector<std::string>* inputPtr, std::string mapName);
-std::vector<std::pair<long long, long long>> transformSourceRanges(std::vector<std::pair<long long, long long>> sourceRanges, RangeMap rangeMap);
 std::vector<std::string> readLines(std::string fileName);
 
 std::regex digitPattern("\\d+");
@@ -87,9 +135,14 @@ long long solution(std::string fileName) {
     rangeMaps.push_back(getMap(&input, "temperature-to-humidity map:"));
     rangeMaps.push_back(getMap(&input, "humidity-to-location map:"));
 
-    std::vector<std::pair<long long, long long>> destinationRanges = seedRanges;
-    for (RangeMap rangeMap : rangeMaps) {
-        destinationRanges = transformSourceRanges(destinationRanges, rangeMap);
+    RangeMap seedToLocation = rangeMaps[0];
+    for (size_t i = 1; i < rangeMaps.size(); ++i) {
+        seedToLocation = seedToLocation.then(rangeMaps[i]);
+    }
+
+    std::vector<std::pair<long long, long long>> destinationRanges = {};
+    for (std::pair<long long, long long> seedRange : seedRanges) {
+        seedToLocation.getValueRanges(seedRange.first, seedRange.second, destinationRanges);
     }
 
     std::vector<long long> locations = {};
@@ -137,43 +190,10 @@ RangeMap getMap(std::vector<std::string>* inputPtr, std::string mapName) {
             break;
         }
     }
+    rangeMap.finalise();
     return rangeMap;
 }
 
-std::vector<std::pair<long long, long long>> transformSourceRanges(std::vector<std::pair<long long, long long>> sourceRanges, RangeMap rangeMap) {
-    std::vector<std::pair<long long, long long>> destinationRanges = {};
-    int sourceRangesIndex = 0;
-    std::pair<long long, long long> sourceRange = sourceRanges[sourceRangesIndex];
-    bool finished = false;
-    while (!finished) {
-        long long sourceStart = sourceRange.first;
-        long long rangeLength = sourceRange.second;
-        long long sourceEnd = sourceStart + rangeLength - 1;
-
-        long long newSourceEnd = rangeMap.findSourceOverlapPoint(sourceStart, rangeLength);
-        long long newRangeLength = newSourceEnd - sourceStart + 1;
-
-        long long destinationStart = rangeMap.getValue(sourceStart);
-        destinationRanges.push_back(std::pair<long long, long long>(destinationStart, newRangeLength));
-
-        // If the new source end is equal to the original source end, move to the next source range.
-        if (newSourceEnd == sourceEnd) {
-            ++sourceRangesIndex;
-            if (sourceRangesIndex == sourceRanges.size()) {
-                finished = true;
-            }
-            else {
-                sourceRange = sourceRanges[sourceRangesIndex];
-            }
-        }
-        // Otherwise, there is a bit of the range left over. Make that the next source range.
-        else {
-            sourceRange = std::pair<long long, long long>(newSourceEnd + 1, rangeLength - newRangeLength);
-        }
-    }
-    return destinationRanges;
-}
-
 std::vector<std::string> readLines(std::string fileName) {
     std::vector<std::string> lines;
     std::ifstream inputFile(fileName);
@@ -10,102 +10,107 @@
 #include <regex>
 #include <numeric>
 #include <cmath>
+#include <algorithm>
+#include <thread>
 
-int solution1(std::string fileName);
-int solution2(std::string fileName);
+// Everything is done in 128-bit integers so that time * time can't overflow
+// and no precision is lost to floating point.
+typedef __int128 int128;
+
+long long solution(std::string fileName);
+int128 integerSqrt(int128 n);
+long long countWinningHoldTimes(long long time, long long distanceToBeat);
+std::vector<long long> countWinningHoldTimes(const std::vector<long long>& times, const std::vector<long long>& distances);
 std::vector<std::string> readLines(std::string fileName);
 
 std::regex digitPattern("\\d+");
 
 int main() {
     std::cout << std::endl;
-    std::cout << "Example Solution 1: " << solution1("example.txt") << " (expected 288)" << std::endl;
-    std::cout << "Input Solution 1: " << solution1("input.txt") << std::endl;
-    std::cout << "" << std::endl;
-    std::cout << "Example Solution 2: " << solution2("example.txt") << " (expected 288)" << std::endl;
-    std::cout << "Input Solution 2: " << solution2("input.txt") << std::endl;
+    std::cout << "Example Solution: " << solution("example.txt") << " (expected 288)" << std::endl;
+    std::cout << "Input Solution: " << solution("input.txt") << std::endl;
     std::cout << std::endl;
 }
 
-int solution1(std::string fileName) {
+long long solution(std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
 
     std::sregex_iterator end;
     std::sregex_iterator timesIterator(input[0].begin(), input[0].end(), digitPattern);
-    std::vector<int> times = {};
+    std::vector<long long> times = {};
     while (timesIterator != end) {
-        times.push_back(stoi((*timesIterator)[0]));
+        times.push_back(stoll((*timesIterator)[0]));
         ++timesIterator;
     }
     std::sregex_iterator distancesIterator(input[1].begin(), input[1].end(), digitPattern);
-    std::vector<int> distances = {};
+    std::vector<long long> distances = {};
     while (distancesIterator != end) {
-        distances.push_back(stoi((*distancesIterator)[0]));
+        distances.push_back(stoll((*distancesIterator)[0]));
         ++distancesIterator;
     }
 
-    std::vector<int> numberOfWinningStrategies = {};
-    for (int index = 0; index < times.size(); ++index) {
-        int time = times[index];
-        int distanceToBeat = distances[index];
-
-        int lowerBound;
-        for (int t1 = 0; t1 < time; ++t1) {
-            int t2 = time - t1;
-            int distance = t1 * t2;
-            if (distance > distanceToBeat) {
-                lowerBound = t1;
-                break;
-            }
-        }
-        int upperBound;
-        for (int t1 = time; t1 >= 0; --t1) {
-            int t2 = time - t1;
-            int distance = t1 * t2;
-            if (distance > distanceToBeat) {
-                upperBound = t1;
-                break;
-            }
-        }
+    std::vector<long long> numberOfWinningStrategies = countWinningHoldTimes(times, distances);
+    return std::accumulate(numberOfWinningStrategies.begin(), numberOfWinningStrategies.end(), 1LL, std::multiplies<long long>());
+}
 
-        numberOfWinningStrategies.push_back(upperBound - lowerBound + 1);
+// Returns floor(sqrt(n)) for n >= 0. Starts from the floating point estimate
+// and corrects it, since the estimate can be off by one or more once n is
+// beyond 2^53.
+int128 integerSqrt(int128 n) {
+    int128 root = static_cast<int128>(std::sqrt(static_cast<long double>(n)));
+    while (root > 0 && root * root > n) {
+        --root;
     }
-
-    return std::accumulate(numberOfWinningStrategies.begin(), numberOfWinningStrategies.end(), 1, std::multiplies<int>());
+    while ((root + 1) * (root + 1) <= n) {
+        ++root;
+    }
+    return root;
 }
 
-int solution2(std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
+// Returns the number of hold times that beat the record. Holding for t
+// travels t * (time - t), which is symmetric about time / 2, so only the
+// lowest winning hold time needs to be found.
+long long countWinningHoldTimes(long long time, long long distanceToBeat) {
+    auto wins = [&](int128 holdTime) {
+        return holdTime * (time - holdTime) > distanceToBeat;
+    };
+
+    // Even the best hold time (time / 2) has to win.
+    int128 discriminant = static_cast<int128>(time) * time - static_cast<int128>(4) * distanceToBeat;
+    if (discriminant < 0 || !wins(time / 2)) {
+        return 0;
+    }
 
-    std::sregex_iterator end;
-    std::sregex_iterator timesIterator(input[0].begin(), input[0].end(), digitPattern);
-    std::vector<int> times = {};
-    while (timesIterator != end) {
-        times.push_back(stoi((*timesIterator)[0]));
-        ++timesIterator;
+    // The exact root is (time - sqrt(discriminant)) / 2. The integer version
+    // is within one of the lowest winning hold time, so nudge it into place.
+    int128 lowerBound = (time - integerSqrt(discriminant)) / 2;
+    while (lowerBound > 0 && wins(lowerBound - 1)) {
+        --lowerBound;
     }
-    std::sregex_iterator distancesIterator(input[1].begin(), input[1].end(), digitPattern);
-    std::vector<int> distances = {};
-    while (distancesIterator != end) {
-        distances.push_back(stoi((*distancesIterator)[0]));
-        ++distancesIterator;
+    while (!wins(lowerBound)) {
+        ++lowerBound;
     }
 
-    std::vector<int> numberOfWinningStrategies = {};
-    for (int index = 0; index < times.size(); ++index) {
-        int time = times[index];
-        int distanceToBeat = distances[index];
-
-        float x1 = (time + std::sqrt((pow(time, 2)) - 4 * distanceToBeat)) / 2;
-        float x2 = (time - std::sqrt((pow(time, 2)) - 4 * distanceToBeat)) / 2;
-
-        int upperBound = std::ceil(x1) - 1;
-        int lowerBound = std::floor(x2) + 1;
+    return static_cast<long long>(time - 2 * lowerBound + 1);
+}
 
-        numberOfWinningStrategies.push_back(upperBound - lowerBound + 1);
+// Counts the winning hold times of every race, splitting the races evenly
+// between threads.
+std::vector<long long> countWinningHoldTimes(const std::vector<long long>& times, const std::vector<long long>& distances) {
+    std::vector<long long> counts(times.size(), 0);
+    size_t threadCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), times.size()));
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&, i]() {
+            for (size_t index = times.size() * i / threadCount; index < times.size() * (i + 1) / threadCount; ++index) {
+                counts[index] = countWinningHoldTimes(times[index], distances[index]);
+            }
+        });
     }
-
-    return std::accumulate(numberOfWinningStrategies.begin(), numberOfWinningStrategies.end(), 1, std::multiplies<int>());
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return counts;
 }
 
 std::vector<std::string> readLines(std::string fileName) {
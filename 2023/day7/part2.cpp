@@ -7,164 +7,50 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <sstream>
-#include <map>
+#include <array>
 #include <algorithm>
-
-class Hand {
-public:
-    enum Card { JOKER=1, TWO, THREE, FOUR, FIVE, SIX, SEVEN, EIGHT, NINE, TEN, QUEEN, KING, ACE };
-    enum HandType { HIGH_CARD, ONE_PAIR, TWO_PAIR, THREE_OF_A_KIND, FULL_HOUSE, FOUR_OF_A_KIND, FIVE_OF_A_KIND };
-
-    static Card determineCardFromChar(const char c) {
-        switch (c) {
-            case 'J': return JOKER;
-            case '2': return TWO;
-            case '3': return THREE;
-            case '4': return FOUR;
-            case '5': return FIVE;
-            case '6': return SIX;
-            case '7': return SEVEN;
-            case '8': return EIGHT;
-            case '9': return NINE;
-            case 'T': return TEN;
-            case 'Q': return QUEEN;
-            case 'K': return KING;
-            case 'A': return ACE;
-        }
-    }
-
-    static char getCardAsChar(const Card card) {
-        switch (card) {
-            case JOKER: return 'J';
-            case TWO: return '2';
-            case THREE: return '3';
-            case FOUR: return '4';
-            case FIVE: return '5';
-            case SIX: return '6';
-            case SEVEN: return '7';
-            case EIGHT: return '8';
-            case NINE: return '9';
-            case TEN: return 'T';
-            case QUEEN: return 'Q';
-            case KING: return 'K';
-            case ACE: return 'A';
-        }
-    }
-
-    static HandType determineHandType(const std::vector<Card> cards) {
-        std::map<Card, int> cardToCount = {};
-        for (Card card : cards) {
-            cardToCount[card] = (cardToCount.find(card) != cardToCount.end()) ? cardToCount[card] + 1 : 1;
-        }
-
-        std::vector<int> counts = {};
-        for (std::pair<char, int> cardAndCount : cardToCount) {
-            if (cardAndCount.first != JOKER) {
-                counts.push_back(cardAndCount.second);
-            }
-        }
-        std::sort(counts.begin(), counts.end(), std::greater<int>());
-
-
-        if (cardToCount[JOKER] == 5) {
-            return FIVE_OF_A_KIND;
-        }
-        else if (!counts.empty()) {
-            counts[0] += cardToCount[JOKER];
-        }
-
-        if (counts[0] == 5) {
-            return FIVE_OF_A_KIND;
-        }
-        else if (counts[0] == 4) {
-            return FOUR_OF_A_KIND;
-        }
-        else if (counts[0] == 3 && counts[1] == 2) {
-            return FULL_HOUSE;
-        }
-        else if (counts[0] == 3) {
-            return THREE_OF_A_KIND;
-        }
-        else if (counts[0] == 2 && counts[1] == 2) {
-            return TWO_PAIR;
-        }
-        else if (counts[0] == 2) {
-            return ONE_PAIR;
-        }
-        else if (counts[0] == 1) {
-            return HIGH_CARD;
-        }
-    }
-
-    static std::string getHandTypeName(const HandType handType) {
-        switch (handType) {
-            case HIGH_CARD: return "HIGH_CARD";
-            case ONE_PAIR: return "ONE_PAIR";
-            case TWO_PAIR: return "TWO_PAIR";
-            case THREE_OF_A_KIND: return "THREE_OF_A_KIND";
-            case FULL_HOUSE: return "FULL_HOUSE";
-            case FOUR_OF_A_KIND: return "FOUR_OF_A_KIND";
-            case FIVE_OF_A_KIND: return "FIVE_OF_A_KIND";
-        }
-    }
-
-private:
-    std::vector<Card> cards = {};
-    HandType handType;
-    int bid;
-
-public:
-    Hand(const std::string cardsString, const int bid) {
-        for (char c : cardsString) {
-            cards.push_back(determineCardFromChar(c));
-        }
-        handType = determineHandType(cards);
-        this->bid = bid;
+#include <cstdint>
+
+enum Card { JOKER=1, TWO, THREE, FOUR, FIVE, SIX, SEVEN, EIGHT, NINE, TEN, QUEEN, KING, ACE };
+enum HandType { HIGH_CARD, ONE_PAIR, TWO_PAIR, THREE_OF_A_KIND, FULL_HOUSE, FOUR_OF_A_KIND, FIVE_OF_A_KIND };
+
+// Each hand is packed into a 32-bit sort key: the hand type in bits 20-22,
+// then the five cards as 4-bit ranks, first card highest. Comparing keys
+// compares hand types first and then the cards in order, just like the game.
+// The bid is kept in the low half of a 64-bit entry alongside the key.
+typedef uint64_t PackedHand;
+
+const int cardBits = 4;
+const int handTypeShift = 5 * cardBits;
+
+long long solution(std::string fileName);
+uint32_t encodeHand(const std::string& cards);
+void radixSortHands(std::vector<PackedHand>& hands);
+
+// Maps each character to its card rank (0 for anything that isn't a card).
+const std::array<uint8_t, 256> cardRanks = []() {
+    std::array<uint8_t, 256> ranks = {};
+    const std::string cardChars = "J23456789TQKA";
+    for (size_t i = 0; i < cardChars.size(); ++i) {
+        ranks[static_cast<unsigned char>(cardChars[i])] = JOKER + i;
     }
-
-    bool operator<(const Hand& other) const {
-        if (handType == other.handType) {
-            for (int i = 0; i < 5; ++i) {
-                if (cards[i] != other.cards[i]) {
-                    return cards[i] < other.cards[i];
-                }
-            }
-            return false;
-        }
-        else {
-            return handType < other.handType;
-        }
-    }
-
-    std::vector<Card> getCards() {
-        return cards;
-    }
-
-    std::string getCardsAsString() {
-        std::string cardsString;
-        for (Card card : cards) {
-            cardsString += getCardAsChar(card);
-        }
-        return cardsString;
-    }
-
-    HandType getHandType() {
-        return handType;
-    }
-
-    std::string getHandTypeName() {
-        return getHandTypeName(handType);
-    }
-
-    int getBid() {
-        return bid;
-    }
-
-};
-
-int solution(std::string fileName);
-std::vector<std::string> readLines(std::string fileName);
+    return ranks;
+}();
+
+// The sum over the five cards of how many times each one appears in the hand
+// (i.e. the sum of the squared card counts) is different for every hand type,
+// so it can index straight into a table.
+const std::array<HandType, 26> handTypeBySquareSum = []() {
+    std::array<HandType, 26> handTypes = {};
+    handTypes[5] = HIGH_CARD;        // 1+1+1+1+1
+    handTypes[7] = ONE_PAIR;         // 4+1+1+1
+    handTypes[9] = TWO_PAIR;         // 4+4+1
+    handTypes[11] = THREE_OF_A_KIND; // 9+1+1
+    handTypes[13] = FULL_HOUSE;      // 9+4
+    handTypes[17] = FOUR_OF_A_KIND;  // 16+1
+    handTypes[25] = FIVE_OF_A_KIND;  // 25
+    return handTypes;
+}();
 
 int main() {
     std::cout << std::endl;
@@ -173,40 +59,68 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(std::string fileName) {
-    std::vector<std::string> input = readLines(fileName);
+long long solution(std::string fileName) {
+    std::ifstream inputFile(fileName);
+    if (inputFile.fail()) {
+        std::cout << "The file doesn't exist you dummy!" << std::endl;
+        return 0;
+    }
 
-    std::vector<Hand> hands = {};
-    for (std::string line : input) {
-        std::istringstream iss(line);
-        std::string cards, bid;
-        iss >> cards >> bid;
-        hands.push_back(Hand(cards, std::stoi(bid)));
+    std::vector<PackedHand> hands = {};
+    std::string cards;
+    uint32_t bid;
+    while (inputFile >> cards >> bid) {
+        hands.push_back((static_cast<PackedHand>(encodeHand(cards)) << 32) | bid);
     }
-    std::sort(hands.begin(), hands.end());
+    radixSortHands(hands);
 
-    int sum = 0;
-    for (int i = 0; i < hands.size(); ++i) {
-        sum += (i + 1) * hands[i].getBid();
+    long long sum = 0;
+    for (size_t i = 0; i < hands.size(); ++i) {
+        sum += (i + 1) * static_cast<long long>(hands[i] & 0xFFFFFFFF);
     }
 
     return sum;
 }
 
-std::vector<std::string> readLines(std::string fileName) {
-    std::vector<std::string> lines;
-    std::ifstream inputFile(fileName);
+uint32_t encodeHand(const std::string& cards) {
+    std::array<uint8_t, 16> cardCounts = {};
+    std::array<uint8_t, 5> ranks;
+    uint32_t key = 0;
+    for (int i = 0; i < 5; ++i) {
+        ranks[i] = cardRanks[static_cast<unsigned char>(cards[i])];
+        cardCounts[ranks[i]] += 1;
+        key = (key << cardBits) | ranks[i];
+    }
 
-    if (inputFile.fail()) {
-        std::cout << "The file doesn't exist you dummy!" << std::endl;
+    // Jokers always join the most common other card. Adding j jokers to a
+    // count of m raises the square sum by (m + j)^2 - m^2. Five jokers give
+    // m = 0 and a square sum of 25, which is five of a kind as it should be.
+    int jokers = cardCounts[JOKER];
+    cardCounts[JOKER] = 0;
+    int squareSum = 0;
+    for (int i = 0; i < 5; ++i) {
+        squareSum += cardCounts[ranks[i]];
     }
-    else {
-        std::string line;
-        while (std::getline(inputFile, line)) {
-            lines.push_back(line);
+    int mostCommon = *std::max_element(cardCounts.begin(), cardCounts.end());
+    squareSum += 2 * mostCommon * jokers + jokers * jokers;
+    return (static_cast<uint32_t>(handTypeBySquareSum[squareSum]) << handTypeShift) | key;
+}
+
+// Least significant digit radix sort on the 23-bit key, one byte at a time.
+// Each pass is stable, so hands end up ordered by the whole key.
+void radixSortHands(std::vector<PackedHand>& hands) {
+    std::vector<PackedHand> buffer(hands.size());
+    for (int shift = 32; shift < 32 + handTypeShift + 3; shift += 8) {
+        std::array<size_t, 257> offsets = {};
+        for (PackedHand hand : hands) {
+            offsets[((hand >> shift) & 0xFF) + 1] += 1;
         }
-        inputFile.close();
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+        for (PackedHand hand : hands) {
+            buffer[offsets[(hand >> shift) & 0xFF]++] = hand;
+        }
+        hands.swap(buffer);
     }
-
-    return lines;
 }
@@ -7,11 +7,63 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <map>
-#include <regex>
+#include <bitset>
+#include <cstdint>
+
+// The network compiled down to integers. Each three character node name is
+// packed as a base-36 number, so it can index flat successor tables directly
+// without any hashing, and the "ends in Z" test becomes a bitset lookup.
+class Network {
+private:
+    static const int nodeCount = 36 * 36 * 36;
+
+    std::vector<uint16_t> leftNodes;
+    std::vector<uint16_t> rightNodes;
+    std::bitset<nodeCount> endNodes;
+    std::vector<uint16_t> startNodes;
+
+    static int getDigit(char c) {
+        return (c >= '0' && c <= '9') ? c - '0' : c - 'A' + 10;
+    }
+
+public:
+    Network(const std::vector<std::string>& input) : leftNodes(nodeCount, 0), rightNodes(nodeCount, 0) {
+        // Lines look like "AAA = (BBB, CCC)".
+        for (size_t index = 2; index < input.size(); ++index) {
+            const std::string& line = input[index];
+            if (line.size() < 15) {
+                continue;
+            }
+            uint16_t node = getNodeId(line.c_str());
+            leftNodes[node] = getNodeId(line.c_str() + 7);
+            rightNodes[node] = getNodeId(line.c_str() + 12);
+            if (line[2] == 'A') {
+                startNodes.push_back(node);
+            }
+            if (line[2] == 'Z') {
+                endNodes.set(node);
+            }
+        }
+    }
+
+    static uint16_t getNodeId(const char* name) {
+        return (getDigit(name[0]) * 36 + getDigit(name[1])) * 36 + getDigit(name[2]);
+    }
+
+    uint16_t step(uint16_t node, char instruction) const {
+        return instruction == 'L' ? leftNodes[node] : rightNodes[node];
+    }
+
+    bool isEndNode(uint16_t node) const {
+        return endNodes.test(node);
+    }
+
+    const std::vector<uint16_t>& getStartNodes() const {
+        return startNodes;
+    }
+};
 
 int solution(const std::string fileName);
-std::map<std::string, std::pair<std::string, std::string>> buildNetworkMap(const std::vector<std::string>& input);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
@@ -26,21 +78,14 @@ int solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
 
     std::string instructions = input[0];
-    std::map<std::string, std::pair<std::string, std::string>> networkMap = buildNetworkMap(input);
+    Network network(input);
 
     int stepCounter = 0;
-    int instructionIndex = 0;
-    std::string currentLocation = "AAA";
-    while (currentLocation != "ZZZ") {
-        std::pair<std::string, std::string> nodes = networkMap[currentLocation];
-        char instruction = instructions[instructionIndex];
-
-        if (instruction == 'L') {
-            currentLocation = nodes.first;
-        }
-        else if (instruction == 'R') {
-            currentLocation = nodes.second;
-        }
+    size_t instructionIndex = 0;
+    uint16_t currentLocation = Network::getNodeId("AAA");
+    const uint16_t finalLocation = Network::getNodeId("ZZZ");
+    while (currentLocation != finalLocation) {
+        currentLocation = network.step(currentLocation, instructions[instructionIndex]);
 
         ++stepCounter;
         ++instructionIndex;
@@ -52,21 +97,6 @@ int solution(const std::string fileName) {
     return stepCounter;
 }
 
-std::map<std::string, std::pair<std::string, std::string>> buildNetworkMap(const std::vector<std::string>& input) {
-    std::map<std::string, std::pair<std::string, std::string>> networkMap = {};
-    std::regex locationPattern("[A-Z]{3}");
-    for (int index = 2; index < input.size(); ++index) {
-        std::sregex_iterator iterator(input[index].begin(), input[index].end(), locationPattern);
-        std::string key = (*iterator)[0];
-        ++iterator;
-        std::string value1 = (*iterator)[0];
-        ++iterator;
-        std::string value2 = (*iterator)[0];
-        networkMap[key] = std::pair<std::string, std::string>(value1, value2);
-    }
-    return networkMap;
-}
-
 std::vector<std::string> readLines(const std::string fileName) {
     std::vector<std::string> lines;
     std::ifstream inputFile(fileName);
@@ -7,16 +7,89 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <map>
-#include <regex>
-#include <cmath>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <thread>
+
+// The network compiled down to integers. Each three character node name is
+// packed as a base-36 number, so it can index flat successor tables directly
+// without any hashing, and the "ends in Z" test becomes a bitset lookup.
+class Network {
+private:
+    static const int nodeCount = 36 * 36 * 36;
+
+    std::vector<uint16_t> leftNodes;
+    std::vector<uint16_t> rightNodes;
+    std::bitset<nodeCount> endNodes;
+    std::vector<uint16_t> startNodes;
+
+    static int getDigit(char c) {
+        return (c >= '0' && c <= '9') ? c - '0' : c - 'A' + 10;
+    }
+
+public:
+    Network(const std::vector<std::string>& input) : leftNodes(nodeCount, 0), rightNodes(nodeCount, 0) {
+        // Lines look like "AAA = (BBB, CCC)".
+        for (size_t index = 2; index < input.size(); ++index) {
+            const std::string& line = input[index];
+            if (line.size() < 15) {
+                continue;
+            }
+            uint16_t node = getNodeId(line.c_str());
+            leftNodes[node] = getNodeId(line.c_str() + 7);
+            rightNodes[node] = getNodeId(line.c_str() + 12);
+            if (line[2] == 'A') {
+                startNodes.push_back(node);
+            }
+            if (line[2] == 'Z') {
+                endNodes.set(node);
+            }
+        }
+    }
+
+    static uint16_t getNodeId(const char* name) {
+        return (getDigit(name[0]) * 36 + getDigit(name[1])) * 36 + getDigit(name[2]);
+    }
+
+    uint16_t step(uint16_t node, char instruction) const {
+        return instruction == 'L' ? leftNodes[node] : rightNodes[node];
+    }
+
+    bool isEndNode(uint16_t node) const {
+        return endNodes.test(node);
+    }
+
+    const std::vector<uint16_t>& getStartNodes() const {
+        return startNodes;
+    }
+};
+
+typedef __int128 int128;
+
+// Where a ghost's walk ends up. Its state is the node together with the
+// position in the instructions, so after tailLength steps it must be going
+// round a loop of cycleLength steps forever. Z hits are stored as step counts
+// from the start: tailHits are the ones before the loop is reached and
+// cycleHits the ones during its first lap.
+struct GhostCycle {
+    long long tailLength;
+    long long cycleLength;
+    std::vector<long long> tailHits;
+    std::vector<long long> cycleHits;
+};
+
+// All step counts equal to remainder modulo modulus.
+struct Congruence {
+    int128 remainder;
+    int128 modulus;
+};
 
 long long solution(const std::string fileName);
-std::vector<std::string> getStartingLocations(const std::vector<std::string>& input);
-std::map<std::string, std::pair<std::string, std::string>> buildNetworkMap(const std::vector<std::string>& input);
-long long getSteps(const std::string instructions, const std::map<std::string, std::pair<std::string, std::string>>& networkMap, const std::string location);
-long long getLCM(std::vector<long long> numbers);
-std::vector<int> getPrimeFactors(long long number);
+GhostCycle analyseGhost(const std::string& instructions, const Network& network, uint16_t location);
+bool isHit(const GhostCycle& ghost, long long steps);
+bool combineCongruences(const Congruence& a, const Congruence& b, Congruence& result);
+int128 extendedGcd(int128 a, int128 b, int128& x, int128& y);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
@@ -28,114 +101,177 @@ int main() {
 
 long long solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
+    if (input.empty()) {
+        return 0;
+    }
 
     std::string instructions = input[0];
-    std::vector<std::string> startingLocations = getStartingLocations(input);
-    std::map<std::string, std::pair<std::string, std::string>> networkMap = buildNetworkMap(input);
-
-    std::vector<long long> stepCounts = {};
-    for (std::string location : startingLocations) {
-        stepCounts.push_back(getSteps(instructions, networkMap, location));
+    Network network(input);
+    const std::vector<uint16_t>& startingLocations = network.getStartNodes();
+    if (startingLocations.empty()) {
+        return 0;
     }
 
-    return getLCM(stepCounts);
-}
+    // Every ghost is analysed on its own thread.
+    std::vector<GhostCycle> ghosts(startingLocations.size());
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < startingLocations.size(); ++index) {
+        threads.emplace_back([&, index]() {
+            ghosts[index] = analyseGhost(instructions, network, startingLocations[index]);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
 
-std::vector<std::string> getStartingLocations(const std::vector<std::string>& input) {
-    std::vector<std::string> locations = {};
-    std::regex startingLocationPattern("[A-Z0-9]{2}A");
-    for (int index = 2; index < input.size(); ++index) {
-        std::string location = input[index].substr(0, 3);
-        if (std::regex_match(location, startingLocationPattern)) {
-            locations.push_back(location);
+    // Before the ghost with the longest tail reaches its loop, only its tail
+    // hits can be answers, so check those against everyone else first.
+    const GhostCycle& longestTail = *std::max_element(ghosts.begin(), ghosts.end(), [](const GhostCycle& a, const GhostCycle& b) {
+        return a.tailLength < b.tailLength;
+    });
+    for (long long steps : longestTail.tailHits) {
+        bool allHit = std::all_of(ghosts.begin(), ghosts.end(), [&](const GhostCycle& ghost) {
+            return isHit(ghost, steps);
+        });
+        if (allHit) {
+            return steps;
         }
     }
-    return locations;
-}
 
-std::map<std::string, std::pair<std::string, std::string>> buildNetworkMap(const std::vector<std::string>& input) {
-    std::map<std::string, std::pair<std::string, std::string>> networkMap = {};
-    std::regex locationPattern("[A-Z0-9]{3}");
-    for (int index = 2; index < input.size(); ++index) {
-        std::sregex_iterator iterator(input[index].begin(), input[index].end(), locationPattern);
-        std::string key = (*iterator)[0];
-        ++iterator;
-        std::string value1 = (*iterator)[0];
-        ++iterator;
-        std::string value2 = (*iterator)[0];
-        networkMap[key] = std::pair<std::string, std::string>(value1, value2);
-    }
-    return networkMap;
-}
+    // After that every ghost is in its loop, so an answer has to agree with
+    // one of each ghost's cycle hits modulo its cycle length. Combine every
+    // choice of hits with the CRT; the moduli needn't be coprime.
+    std::vector<Congruence> congruences = { { 0, 1 } };
+    for (const GhostCycle& ghost : ghosts) {
+        std::vector<Congruence> combined = {};
+        for (const Congruence& congruence : congruences) {
+            for (long long hit : ghost.cycleHits) {
+                Congruence result;
+                if (combineCongruences(congruence, { hit % ghost.cycleLength, ghost.cycleLength }, result)) {
+                    combined.push_back(result);
+                }
+            }
+        }
+        congruences = combined;
+    }
 
-long long getSteps(const std::string instructions, const std::map<std::string, std::pair<std::string, std::string>>& networkMap, const std::string location) {
-    long long stepCounter = 0;
-    int instructionIndex = 0;
-    std::string currentLocation = location;
-    std::regex finalLocationPattern("[A-Z0-9]{2}Z");
-    while (!std::regex_match(currentLocation, finalLocationPattern)) {
-        std::pair<std::string, std::string> nodes = networkMap.at(currentLocation);
-        char instruction = instructions[instructionIndex];
-
-        if (instruction == 'L') {
-            currentLocation = nodes.first;
+    // The smallest solution of each congruence that's past every tail.
+    int128 bestSteps = -1;
+    for (const Congruence& congruence : congruences) {
+        int128 steps = congruence.remainder;
+        if (steps < longestTail.tailLength) {
+            steps += (longestTail.tailLength - steps + congruence.modulus - 1) / congruence.modulus * congruence.modulus;
         }
-        else if (instruction == 'R') {
-            currentLocation = nodes.second;
+        if (bestSteps == -1 || steps < bestSteps) {
+            bestSteps = steps;
         }
+    }
 
-        ++stepCounter;
+    if (bestSteps == -1) {
+        std::cout << "The ghosts never all reach Z at the same time!" << std::endl;
+    }
+    return static_cast<long long>(bestSteps);
+}
+
+GhostCycle analyseGhost(const std::string& instructions, const Network& network, uint16_t location) {
+    // A state is the instruction index in the high bits and the node in the
+    // low 16 bits.
+    auto advance = [&](uint64_t state) {
+        uint64_t instructionIndex = state >> 16;
+        uint16_t node = network.step(static_cast<uint16_t>(state), instructions[instructionIndex]);
         ++instructionIndex;
         if (instructionIndex == instructions.length()) {
             instructionIndex = 0;
         }
-    }
-    return stepCounter;
-}
-
-long long getLCM(std::vector<long long> numbers) {
-    std::map<int, int> maxPrimeFactorCounts = {};
+        return (instructionIndex << 16) | node;
+    };
 
-    for (long long number : numbers) {
-        std::vector<int> primeFactors = getPrimeFactors(number);
-
-        std::map<int, int> primeFactorCounts = {};
-        for (int primeFactor : primeFactors) {
-            primeFactorCounts[primeFactor]++;
+    // Brent's algorithm. Find the cycle length by teleporting the tortoise to
+    // the hare at every power of two...
+    const uint64_t startState = location;
+    long long power = 1;
+    long long cycleLength = 1;
+    uint64_t tortoise = startState;
+    uint64_t hare = advance(startState);
+    while (tortoise != hare) {
+        if (power == cycleLength) {
+            tortoise = hare;
+            power *= 2;
+            cycleLength = 0;
         }
+        hare = advance(hare);
+        ++cycleLength;
+    }
 
-        for (std::pair<int, int> factorAndCount : primeFactorCounts) {
-            maxPrimeFactorCounts[factorAndCount.first] = std::max(maxPrimeFactorCounts[factorAndCount.first], factorAndCount.second);
-        }
+    // ...then walk two pointers a cycle length apart from the start until
+    // they meet at the beginning of the loop.
+    long long tailLength = 0;
+    tortoise = startState;
+    hare = startState;
+    for (long long step = 0; step < cycleLength; ++step) {
+        hare = advance(hare);
+    }
+    while (tortoise != hare) {
+        tortoise = advance(tortoise);
+        hare = advance(hare);
+        ++tailLength;
     }
 
-    long long lcm = 1;
-    for (std::pair<int, int> factorAndMaxCount : maxPrimeFactorCounts) {
-        lcm *= std::pow(factorAndMaxCount.first, factorAndMaxCount.second);
+    GhostCycle ghost = { tailLength, cycleLength, {}, {} };
+    uint64_t state = startState;
+    for (long long step = 0; step < tailLength + cycleLength; ++step) {
+        if (network.isEndNode(static_cast<uint16_t>(state))) {
+            (step < tailLength ? ghost.tailHits : ghost.cycleHits).push_back(step);
+        }
+        state = advance(state);
     }
-    return lcm;
+    return ghost;
 }
 
-std::vector<int> getPrimeFactors(long long number) {
-    std::vector<int> primeFactors = {};
-
-    while (number % 2 == 0) {
-        primeFactors.push_back(2);
-        number /= 2;
+bool isHit(const GhostCycle& ghost, long long steps) {
+    if (steps < ghost.tailLength) {
+        return std::binary_search(ghost.tailHits.begin(), ghost.tailHits.end(), steps);
     }
+    long long offset = (steps - ghost.tailLength) % ghost.cycleLength + ghost.tailLength;
+    return std::binary_search(ghost.cycleHits.begin(), ghost.cycleHits.end(), offset);
+}
 
-    for (long long i = 3; i <= std::sqrt(number); i += 2) {
-        while (number % i == 0) {
-            primeFactors.push_back(i);
-            number /= i;
-        }
+// Merges x = a.remainder (mod a.modulus) and x = b.remainder (mod b.modulus)
+// into a single congruence modulo their LCM, if they have a common solution.
+bool combineCongruences(const Congruence& a, const Congruence& b, Congruence& result) {
+    int128 x;
+    int128 y;
+    int128 gcd = extendedGcd(a.modulus, b.modulus, x, y);
+    int128 difference = b.remainder - a.remainder;
+    if (difference % gcd != 0) {
+        return false;
     }
 
-    if (number > 2) {
-        primeFactors.push_back(number);
+    // a.modulus * x = gcd (mod b.modulus), so stepping a.remainder by
+    // a.modulus * x * difference / gcd lands on b.remainder.
+    int128 reducedModulus = b.modulus / gcd;
+    int128 multiplier = (difference / gcd % reducedModulus) * (x % reducedModulus) % reducedModulus;
+    if (multiplier < 0) {
+        multiplier += reducedModulus;
     }
 
-    return primeFactors;
+    result.modulus = a.modulus * reducedModulus;
+    result.remainder = (a.remainder + a.modulus * multiplier) % result.modulus;
+    return true;
+}
+
+int128 extendedGcd(int128 a, int128 b, int128& x, int128& y) {
+    if (b == 0) {
+        x = 1;
+        y = 0;
+        return a;
+    }
+    int128 x1;
+    int128 y1;
+    int128 gcd = extendedGcd(b, a % b, x1, y1);
+    x = y1;
+    y = x1 - (a / b) * y1;
+    return gcd;
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
@@ -7,10 +7,54 @@
 #include <string>
 #include <vector>
 #include <fstream>
-#include <regex>
+#include <cstdlib>
 
-int solution(const std::string fileName);
-std::vector<int> calculateFirstSequenceNumbers(const std::vector<int>& sequence);
+typedef __int128 int128;
+
+// Extrapolates sequences one step past either end. The difference table of a
+// sequence of n values bottoms out after n levels, which makes the next value
+// sum((-1)^(n-1-i) * C(n, i) * x[i]) and, by symmetry, the previous value the
+// same weights applied to the sequence reversed. The weights only depend on
+// the length, so each row is worked out once and reused for every sequence.
+class Extrapolator {
+private:
+    std::vector<std::vector<int128>> weightRows;
+
+    const std::vector<int128>& getWeights(size_t length) {
+        while (weightRows.size() <= length) {
+            size_t n = weightRows.size();
+            std::vector<int128> weights(n);
+            int128 binomial = 1;
+            for (size_t i = 0; i < n; ++i) {
+                weights[i] = ((n - 1 - i) % 2 == 0) ? binomial : -binomial;
+                binomial = binomial * (n - i) / (i + 1);
+            }
+            weightRows.push_back(weights);
+        }
+        return weightRows[length];
+    }
+
+public:
+    int128 getNext(const std::vector<long long>& sequence) {
+        const std::vector<int128>& weights = getWeights(sequence.size());
+        int128 value = 0;
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            value += weights[i] * sequence[i];
+        }
+        return value;
+    }
+
+    int128 getPrevious(const std::vector<long long>& sequence) {
+        const std::vector<int128>& weights = getWeights(sequence.size());
+        int128 value = 0;
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            value += weights[sequence.size() - 1 - i] * sequence[i];
+        }
+        return value;
+    }
+};
+
+long long solution(const std::string fileName);
 std::vector<std::string> readLines(const std::string fileName);
 
 int main() {
@@ -20,52 +64,25 @@ int main() {
     std::cout << std::endl;
 }
 
-int solution(const std::string fileName) {
+long long solution(const std::string fileName) {
     std::vector<std::string> input = readLines(fileName);
-    std::regex numberPattern("-?\\d+");
+    Extrapolator extrapolator;
 
-    int sum = 0;
-    for (std::string line : input) {
-        std::vector<int> baseSequence;
-        std::sregex_iterator iterator(line.begin(), line.end(), numberPattern);
-        std::sregex_iterator end;
-        while (iterator != end) {
-            baseSequence.push_back(std::stoi((*iterator)[0]));
-            ++iterator;
+    int128 sum = 0;
+    std::vector<long long> baseSequence;
+    for (const std::string& line : input) {
+        baseSequence.clear();
+        const char* position = line.c_str();
+        char* numberEnd;
+        for (long long number = std::strtoll(position, &numberEnd, 10); numberEnd != position; number = std::strtoll(position, &numberEnd, 10)) {
+            baseSequence.push_back(number);
+            position = numberEnd;
         }
 
-        std::vector<int> firstSequenceNumbers = calculateFirstSequenceNumbers(baseSequence);
-        int previousSequenceNumber = 0;
-        for (int firstSequenceNumber : firstSequenceNumbers) {
-            previousSequenceNumber  = firstSequenceNumber - previousSequenceNumber;
-        }
-
-        sum += previousSequenceNumber;
+        sum += extrapolator.getPrevious(baseSequence);
     }
 
-    return sum;
-}
-
-std::vector<int> calculateFirstSequenceNumbers(const std::vector<int>& sequence) {
-    bool allZeros = true;
-    for (int n : sequence) {
-        if (n != 0) {
-            allZeros = false;
-        }
-    }
-
-    if (allZeros) {
-        return {0};
-    }
-    else {
-        std::vector<int> newSequence;
-        for (int i = 0; i < sequence.size() - 1; ++i) {
-            newSequence.push_back(sequence[i+1] - sequence[i]);
-        }
-        std::vector<int> firstSequenceNumbers = calculateFirstSequenceNumbers(newSequence);
-        firstSequenceNumbers.push_back(sequence.front());
-        return firstSequenceNumbers;
-    }
+    return static_cast<long long>(sum);
 }
 
 std::vector<std::string> readLines(const std::string fileName) {
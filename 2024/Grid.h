@@ -81,7 +81,7 @@ public:
 	size_t                                  GetHeight() const { return mHeight; }
 	size_t                                  GetWidth () const { return mWidth;  }
 
-	bool                                    WithinBounds(const GridPosition& pos);
+	bool                                    WithinBounds(const GridPosition& pos) const;
 
 
 private:
@@ -196,10 +196,10 @@ const T& Grid<T>::operator[](const GridPosition& pos) const
 
 
 //==============================================================================
-//		Grid::WithinBounds(const GridPosition& pos)
+//		Grid::WithinBounds(const GridPosition& pos) const
 //------------------------------------------------------------------------------
 template<typename T>
-bool Grid<T>::WithinBounds(const GridPosition& pos)
+bool Grid<T>::WithinBounds(const GridPosition& pos) const
 {
 	if (pos.rowIndex < 0 || pos.rowIndex >= static_cast<int>(GetHeight()))
 	{
@@ -57,4 +57,31 @@ std::vector<std::string> ReadLines(const std::string& fileName)
 
 
 
+
+
+//==============================================================================
+//		ToString - Converts a 128-bit value to a string, since streams can't
+//		print one directly.
+//------------------------------------------------------------------------------
+std::string ToString(__int128 value)
+{
+	unsigned __int128 magnitude = value < 0 ? -static_cast<unsigned __int128>(value) : value;
+
+	std::string digits;
+	do
+	{
+		digits.push_back(static_cast<char>('0' + magnitude % 10));
+		magnitude /= 10;
+	}
+	while (magnitude != 0);
+
+	if (value < 0)
+	{
+		digits.push_back('-');
+	}
+	return std::string(digits.rbegin(), digits.rend());
+}
+
+
+
 }
@@ -112,6 +112,16 @@ std::vector<std::string> ReadLines(const std::string& fileName);
 
 
 
+//==============================================================================
+//		ToString - Converts a 128-bit value to a string, since streams can't
+//		print one directly.
+//------------------------------------------------------------------------------
+std::string ToString(__int128 value);
+
+
+
+
+
 //==============================================================================
 //		Format - Formats args according to the format string.
 //------------------------------------------------------------------------------
@@ -17,6 +17,8 @@
 #include "ANSIEscapeCodes.h"
 #include "Helper.h"
 
+#include <algorithm>
+#include <bit>
 #include <filesystem>
 #include <format>
 
@@ -62,10 +64,14 @@ namespace Solution
 
 
 //==============================================================================
-//		Map::Map(size_t height, size_t width);
+//		ObstacleIndex::ObstacleIndex(size_t height, size_t width)
 //------------------------------------------------------------------------------
-Map::Map(size_t height, size_t width)
-	: Grid(height, width, '.')
+ObstacleIndex::ObstacleIndex(size_t height, size_t width)
+	: mHeight       (height)
+	, mWidth        (width)
+	, mObstacleCount(0)
+	, mRows         (height)
+	, mCols         (width)
 {}
 
 
@@ -73,70 +79,84 @@ Map::Map(size_t height, size_t width)
 
 
 //==============================================================================
-//		Map::Map(const std::vector<std::vector<char>>& grid)
+//		ObstacleIndex::AddObstacle(int rowIndex, int colIndex)
 //------------------------------------------------------------------------------
-Map::Map(const std::vector<std::vector<char>>& grid)
-	: Grid(grid)
-{}
+void ObstacleIndex::AddObstacle(int rowIndex, int colIndex)
+{
+	mRows[rowIndex].push_back(colIndex);
+	mCols[colIndex].push_back(rowIndex);
+	mObstacleCount += 1;
+}
 
 
 
 
 
 //==============================================================================
-//		Map::Map(std::vector<std::vector<char>>&& grid)
+//		ObstacleIndex::Finalise() - Sorts the obstacles in every row and column.
+//		Must be called after the last obstacle is added and before the first
+//		call to FindStop.
 //------------------------------------------------------------------------------
-Map::Map(std::vector<std::vector<char>>&& grid)
-	: Grid(grid)
-{}
+void ObstacleIndex::Finalise()
+{
+	for (std::vector<int>& row : mRows)
+	{
+		std::sort(row.begin(), row.end());
+	}
+	for (std::vector<int>& col : mCols)
+	{
+		std::sort(col.begin(), col.end());
+	}
+}
 
 
 
 
 
 //==============================================================================
-//		Solve - Returns the solution to the problem for the given input.
+//		ObstacleIndex::FindStop(const GridPosition& guard,
+//		                        Direction           direction,
+//		                        bool&               leavesMap) const
+//		- Returns the last position the guard reaches when walking in the given
+//		direction. This is either the cell in front of the next obstacle, or
+//		the edge of the map, in which case leavesMap is set.
 //------------------------------------------------------------------------------
-int Solve(std::vector<std::string> input, bool debug/* = false*/)
+GridPosition ObstacleIndex::FindStop(const GridPosition& guard,
+                                     Direction           direction,
+                                     bool&               leavesMap) const
 {
-	Helper::PrintIf(debug, "\n==============================================================================");
+	const std::vector<int>& row = mRows[guard.rowIndex];
+	const std::vector<int>& col = mCols[guard.colIndex];
 
-	// Turn the input into a map.
-	Map map(input.size(), input[0].length());
-	GridPosition guard;
-	for (size_t lineIndex = 0; lineIndex < input.size(); ++lineIndex)
+	// The obstacles are sorted, so the next one in each direction is found with
+	// a binary search either side of the guard.
+	if (direction == Direction::North)
 	{
-		for (size_t charIndex = 0; charIndex < input[0].length(); ++charIndex)
-		{
-			char c = input[lineIndex][charIndex];
-			map[lineIndex][charIndex] = c;
-			if (c == '^' || c == '>' || c == 'v' || c == '<')
-			{
-				guard = {static_cast<int>(lineIndex), static_cast<int>(charIndex)};
-			}
-		}
+		std::vector<int>::const_iterator it = std::lower_bound(col.begin(), col.end(), guard.rowIndex);
+		leavesMap = (it == col.begin());
+		return {leavesMap ? 0 : *std::prev(it) + 1, guard.colIndex};
 	}
-
-	// Simulate the guard's movement until they leave the map.
-	Helper::PrintIf(debug, "\n{}", map);
-	while (Move(map, guard, debug));
-	Helper::PrintIf(debug, "\n{}", map);
-
-	// Count the number of unique positions.
-	int total = 0;
-	for (size_t rowIndex = 0; rowIndex < map.GetHeight(); ++rowIndex)
+	else if (direction == Direction::East)
 	{
-		for (size_t colIndex = 0; colIndex < map.GetWidth(); ++colIndex)
-		{
-			if (map[rowIndex][colIndex] == 'X')
-			{
-				total += 1;
-			}
-		}
+		std::vector<int>::const_iterator it = std::upper_bound(row.begin(), row.end(), guard.colIndex);
+		leavesMap = (it == row.end());
+		return {guard.rowIndex, leavesMap ? static_cast<int>(mWidth) - 1 : *it - 1};
+	}
+	else if (direction == Direction::South)
+	{
+		std::vector<int>::const_iterator it = std::upper_bound(col.begin(), col.end(), guard.rowIndex);
+		leavesMap = (it == col.end());
+		return {leavesMap ? static_cast<int>(mHeight) - 1 : *it - 1, guard.colIndex};
+	}
+	else if (direction == Direction::West)
+	{
+		std::vector<int>::const_iterator it = std::lower_bound(row.begin(), row.end(), guard.colIndex);
+		leavesMap = (it == row.begin());
+		return {guard.rowIndex, leavesMap ? 0 : *std::prev(it) + 1};
 	}
 
-	Helper::PrintIf(debug,   "------------------------------------------------------------------------------");
-	return total;
+	REQUIRE(false, "Invalid direction!");
+	return guard;
 }
 
 
@@ -144,131 +164,201 @@ int Solve(std::vector<std::string> input, bool debug/* = false*/)
 
 
 //==============================================================================
-//		Move - Simulates the given guard's movement in the given map. Returns
-//		true if the guard remains on the map and false if they leave it.
+//		VisitedGrid::VisitedGrid(size_t height, size_t width)
 //------------------------------------------------------------------------------
-bool Move(Map& map, GridPosition& guard, bool debug)
-{
-	char currentDirection = map[guard];
+VisitedGrid::VisitedGrid(size_t height, size_t width)
+	: mWordsPerRow((width + 63) / 64)
+	, mWords      (height * mWordsPerRow, 0)
+{}
 
-	// Figure out the new position/direction based on the current position and
-	// direction.
-	GridPosition newPosition;
-	char         newDirection;
-	if (currentDirection == '^')
-	{
-		newPosition  = {guard.rowIndex - 1, guard.colIndex};
-		newDirection = '>';
-	}
-	else if (currentDirection == '>')
-	{
-		newPosition  = {guard.rowIndex, guard.colIndex + 1};
-		newDirection = 'v';
-	}
-	else if (currentDirection == 'v')
-	{
-		newPosition  = {guard.rowIndex + 1, guard.colIndex};
-		newDirection = '<';
-	}
-	else if (currentDirection == '<')
+
+
+
+
+//==============================================================================
+//		VisitedGrid::MarkSpan(const GridPosition& from, const GridPosition& to)
+//		- Marks every cell on the straight line between the two positions,
+//		inclusive.
+//------------------------------------------------------------------------------
+void VisitedGrid::MarkSpan(const GridPosition& from, const GridPosition& to)
+{
+	if (from.rowIndex == to.rowIndex)
 	{
-		newPosition  = {guard.rowIndex, guard.colIndex - 1};
-		newDirection = '^';
+		MarkRowSpan(from.rowIndex, std::min(from.colIndex, to.colIndex), std::max(from.colIndex, to.colIndex));
 	}
 	else
 	{
-		REQUIRE(false, "Invalid direction!");
+		REQUIRE(from.colIndex == to.colIndex, "Span from {} to {} is not straight!", from, to);
+		MarkColSpan(from.colIndex, std::min(from.rowIndex, to.rowIndex), std::max(from.rowIndex, to.rowIndex));
 	}
+}
 
-	// If the new position is not within bounds, the guard will leave the map
-	// this movement.
-	if (!map.WithinBounds(newPosition))
-	{
-		// Mark the current position.
-		map[guard] = 'X';
-		return false;
-	}
-	// If the new position is not an obstacle, the guard will move forward.
-	else if (map[newPosition] != '#')
+
+
+
+
+//==============================================================================
+//		VisitedGrid::MarkRowSpan(int rowIndex, int colStart, int colEnd) - Marks
+//		the cells colStart to colEnd (inclusive) of the given row, a whole word
+//		at a time.
+//------------------------------------------------------------------------------
+void VisitedGrid::MarkRowSpan(int rowIndex, int colStart, int colEnd)
+{
+	uint64_t* row = mWords.data() + rowIndex * mWordsPerRow;
+
+	size_t firstWord = colStart / 64;
+	size_t lastWord  = colEnd   / 64;
+	uint64_t firstMask = ~uint64_t(0) << (colStart % 64);
+	uint64_t lastMask  = ~uint64_t(0) >> (63 - colEnd % 64);
+
+	if (firstWord == lastWord)
 	{
-		// Move the guard.
-		map[guard] = 'X';
-		guard = newPosition;
-		map[guard] = currentDirection;
+		row[firstWord] |= firstMask & lastMask;
+		return;
 	}
-	// Otherwise the guard will rotate 90 degrees clockwise.
-	else
+
+	row[firstWord] |= firstMask;
+	for (size_t wordIndex = firstWord + 1; wordIndex < lastWord; ++wordIndex)
 	{
-		// Rotate the guard
-		map[guard] = newDirection;
-		Helper::PrintIf(debug, "\n{}", map);
+		row[wordIndex] = ~uint64_t(0);
 	}
-
-	return true;
+	row[lastWord] |= lastMask;
 }
 
 
 
-} // Solution
+
+
+//==============================================================================
+//		VisitedGrid::MarkColSpan(int colIndex, int rowStart, int rowEnd) - Marks
+//		the cells rowStart to rowEnd (inclusive) of the given column.
+//------------------------------------------------------------------------------
+void VisitedGrid::MarkColSpan(int colIndex, int rowStart, int rowEnd)
+{
+	size_t   wordOffset = colIndex / 64;
+	uint64_t bit        = uint64_t(1) << (colIndex % 64);
+	for (int rowIndex = rowStart; rowIndex <= rowEnd; ++rowIndex)
+	{
+		mWords[rowIndex * mWordsPerRow + wordOffset] |= bit;
+	}
+}
 
 
 
 
 
 //==============================================================================
-//		std::formatter<Solution::Map, char> - Specialisation of the
-//		std::formatter template for maps.
+//		VisitedGrid::Count() const - Returns the number of marked cells.
 //------------------------------------------------------------------------------
-template<>
-struct std::formatter<Solution::Map, char>
+size_t VisitedGrid::Count() const
 {
-	constexpr auto parse(format_parse_context& ctx)
+	size_t total = 0;
+	for (uint64_t word : mWords)
 	{
-		return ctx.begin(); // No special parsing required.
+		total += std::popcount(word);
 	}
+	return total;
+}
+
+
+
+
 
-	template <typename FormatContext>
-	auto format(const Solution::Map& map, FormatContext& ctx) const
+//==============================================================================
+//		Solve - Returns the solution to the problem for the given input.
+//------------------------------------------------------------------------------
+int Solve(std::vector<std::string> input, bool debug/* = false*/)
+{
+	Helper::PrintIf(debug, "\n==============================================================================");
+
+	// Index the obstacles and find the guard's starting position and
+	// direction.
+	ObstacleIndex index(input.size(), input[0].length());
+	GridPosition guard;
+	Direction    direction = Direction::North;
+	for (size_t lineIndex = 0; lineIndex < input.size(); ++lineIndex)
 	{
-		std::string result;
-		for (size_t rowIndex = 0; rowIndex < map.GetHeight(); ++rowIndex)
+		for (size_t charIndex = 0; charIndex < input[0].length(); ++charIndex)
 		{
-			for (size_t colIndex = 0; colIndex < map.GetWidth(); ++colIndex)
+			char c = input[lineIndex][charIndex];
+			if (c == '#')
 			{
-				char c = map[rowIndex][colIndex];
-				if (c == '#')
-				{
-					result += ANSIEscapeCodes::RED;
-					result += c;
-					result += ANSIEscapeCodes::RESET;
-				}
-				else if (c == 'X')
-				{
-					result += ANSIEscapeCodes::BLUE;
-					result += c;
-					result += ANSIEscapeCodes::RESET;
-				}
-				else if (c == '^' || c == '>' || c == 'v' || c == '<')
-				{
-					result += ANSIEscapeCodes::BOLD;
-					result += ANSIEscapeCodes::GREEN;
-					result += c;
-					result += ANSIEscapeCodes::RESET;
-				}
-				else
-				{
-					result += c;
-				}
-				if (colIndex != map.GetWidth() - 1)
-				{
-					result += " ";
-				}
+				index.AddObstacle(static_cast<int>(lineIndex), static_cast<int>(charIndex));
 			}
-			if (rowIndex != map.GetHeight() - 1)
+			else if (c == '^' || c == '>' || c == 'v' || c == '<')
 			{
-				result += "\n";
+				guard     = {static_cast<int>(lineIndex), static_cast<int>(charIndex)};
+				direction = c == '^' ? Direction::North :
+				            c == '>' ? Direction::East  :
+				            c == 'v' ? Direction::South :
+				                       Direction::West;
 			}
 		}
-		return std::format_to(ctx.out(), "{}", result);
 	}
-};
+	index.Finalise();
+
+	// Simulate the guard's movement until they leave the map.
+	VisitedGrid visited(index.GetHeight(), index.GetWidth());
+	Patrol(index, guard, direction, visited, debug);
+
+	// Count the number of unique positions.
+	int total = static_cast<int>(visited.Count());
+
+	Helper::PrintIf(debug,   "------------------------------------------------------------------------------");
+	return total;
+}
+
+
+
+
+
+//==============================================================================
+//		Patrol - Simulates the guard's patrol one straight leg at a time,
+//		marking every cell they cross in the visited grid, until they leave the
+//		map.
+//------------------------------------------------------------------------------
+void Patrol(const ObstacleIndex& index,
+            GridPosition         guard,
+            Direction            direction,
+            VisitedGrid&         visited,
+            bool                 debug)
+{
+	static const char directionChars[] = {'^', '>', 'v', '<'};
+
+	// Every leg that doesn't leave the map ends facing an obstacle, so there
+	// can only be four legs per obstacle before the guard repeats themself.
+	size_t maxLegs = 4 * index.GetObstacleCount() + 1;
+
+	bool leavesMap = false;
+	for (size_t legs = 0; !leavesMap; ++legs)
+	{
+		REQUIRE(legs < maxLegs, "The guard is stuck in a loop!");
+
+		// Jump to the end of the current leg and mark everything in between.
+		GridPosition stop = index.FindStop(guard, direction, leavesMap);
+		visited.MarkSpan(guard, stop);
+		Helper::PrintIf(debug, "\n{} {} -> {}", directionChars[static_cast<int>(direction)], guard, stop);
+
+		// Rotate the guard.
+		guard     = stop;
+		direction = GetNextDirection(direction);
+	}
+}
+
+
+
+
+
+//==============================================================================
+//		GetNextDirection - Returns the direction the guard will face after
+//		rotating 90 degrees clockwise from the current direction.
+//------------------------------------------------------------------------------
+Direction GetNextDirection(Direction currentDirection)
+{
+	int next = (static_cast<int>(currentDirection) + 1) % static_cast<int>(Direction::NumberOfDirections);
+	return static_cast<Direction>(next);
+}
+
+
+
+} // Solution
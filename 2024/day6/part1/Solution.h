@@ -16,6 +16,7 @@
 //------------------------------------------------------------------------------
 #include "Grid.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -38,14 +39,74 @@ namespace Solution
 
 
 //==============================================================================
-//		Map
+//		Types
 //------------------------------------------------------------------------------
-class Map : public Grid<char>
+enum class Direction
+{
+	North,
+	East,
+	South,
+	West,
+	NumberOfDirections
+};
+
+
+
+
+
+//==============================================================================
+//		ObstacleIndex - For every row and column of the map, the sorted
+//		positions of the obstacles in it. Lets the guard jump straight to the
+//		next turn instead of walking one cell at a time.
+//------------------------------------------------------------------------------
+class ObstacleIndex
 {
 public:
-	                                        Map(size_t height, size_t width);
-	                                        Map(const std::vector<std::vector<char>>& grid);
-	                                        Map(std::vector<std::vector<char>>&& grid);
+	                                        ObstacleIndex(size_t height, size_t width);
+
+	void                                    AddObstacle(int rowIndex, int colIndex);
+	void                                    Finalise();
+
+	GridPosition                            FindStop(const GridPosition& guard,
+	                                                 Direction           direction,
+	                                                 bool&               leavesMap) const;
+
+	size_t                                  GetHeight() const { return mHeight; }
+	size_t                                  GetWidth () const { return mWidth;  }
+	size_t                                  GetObstacleCount() const { return mObstacleCount; }
+
+
+private:
+	size_t                                  mHeight;
+	size_t                                  mWidth;
+	size_t                                  mObstacleCount;
+	std::vector<std::vector<int>>           mRows; // Column indices, per row.
+	std::vector<std::vector<int>>           mCols; // Row indices, per column.
+};
+
+
+
+
+
+//==============================================================================
+//		VisitedGrid - One bit per cell of the map, marked a whole span at a
+//		time.
+//------------------------------------------------------------------------------
+class VisitedGrid
+{
+public:
+	                                        VisitedGrid(size_t height, size_t width);
+
+	void                                    MarkSpan(const GridPosition& from, const GridPosition& to);
+	void                                    MarkRowSpan(int rowIndex, int colStart, int colEnd);
+	void                                    MarkColSpan(int colIndex, int rowStart, int rowEnd);
+
+	size_t                                  Count() const;
+
+
+private:
+	size_t                                  mWordsPerRow;
+	std::vector<uint64_t>                   mWords;
 };
 
 
@@ -62,10 +123,25 @@ int Solve(std::vector<std::string> input, bool debug = false);
 
 
 //==============================================================================
-//		Move - Simulates the given guard's movement in the given map. Returns
-//		true if the guard remains on the map and false if they leave it.
+//		Patrol - Simulates the guard's patrol one straight leg at a time,
+//		marking every cell they cross in the visited grid, until they leave the
+//		map.
+//------------------------------------------------------------------------------
+void Patrol(const ObstacleIndex& index,
+            GridPosition         guard,
+            Direction            direction,
+            VisitedGrid&         visited,
+            bool                 debug);
+
+
+
+
+
+//==============================================================================
+//		GetNextDirection - Returns the direction the guard will face after
+//		rotating 90 degrees clockwise from the current direction.
 //------------------------------------------------------------------------------
-bool Move(Map& map, GridPosition& guard, bool debug);
+Direction GetNextDirection(Direction currentDirection);
 
 
 
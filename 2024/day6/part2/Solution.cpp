@@ -17,8 +17,11 @@
 #include "ANSIEscapeCodes.h"
 #include "Helper.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <format>
+#include <thread>
 
 
 
@@ -83,7 +86,7 @@ Map::Map(const std::vector<std::vector<char>>& grid)
 
 
 
-//==============================================================================position
+//==============================================================================
 //		Map::Map(std::vector<std::vector<char>>&& grid)
 //------------------------------------------------------------------------------
 Map::Map(std::vector<std::vector<char>>&& grid)
@@ -94,6 +97,78 @@ Map::Map(std::vector<std::vector<char>>&& grid)
 
 
 
+//==============================================================================
+//		Map::GetCellIndex(const GridPosition& pos) const - Returns the
+//		row-major index of the given position.
+//------------------------------------------------------------------------------
+size_t Map::GetCellIndex(const GridPosition& pos) const
+{
+	return pos.rowIndex * GetWidth() + pos.colIndex;
+}
+
+
+
+
+
+//==============================================================================
+//		DirectionMaskGrid::DirectionMaskGrid(size_t height, size_t width)
+//------------------------------------------------------------------------------
+DirectionMaskGrid::DirectionMaskGrid(size_t height, size_t width)
+	: mWidth(width)
+	, mMasks((height * width + 1) / 2, 0)
+{}
+
+
+
+
+
+//==============================================================================
+//		DirectionMaskGrid::Clear() - Forgets every visited state by zeroing
+//		only the bytes recorded in the undo log.
+//------------------------------------------------------------------------------
+void DirectionMaskGrid::Clear()
+{
+	for (uint32_t byteIndex : mUndoLog)
+	{
+		mMasks[byteIndex] = 0;
+	}
+	mUndoLog.clear();
+}
+
+
+
+
+
+//==============================================================================
+//		DirectionMaskGrid::Visit(GuardState state) - Records the given state.
+//		Returns true if it had already been recorded since the last clear.
+//------------------------------------------------------------------------------
+bool DirectionMaskGrid::Visit(GuardState state)
+{
+	GridPosition pos       = GetPosition(state);
+	size_t       cellIndex = pos.rowIndex * mWidth + pos.colIndex;
+	Direction    direction = GetDirection(state);
+
+	uint8_t& byte = mMasks[cellIndex / 2];
+	uint8_t  bit  = 1 << ((cellIndex % 2) * 4 + static_cast<int>(direction));
+	if (byte & bit)
+	{
+		return true;
+	}
+
+	// Only log a byte the first time it goes from clear to set.
+	if (byte == 0)
+	{
+		mUndoLog.push_back(static_cast<uint32_t>(cellIndex / 2));
+	}
+	byte |= bit;
+	return false;
+}
+
+
+
+
+
 //==============================================================================
 //		Solve - Returns the solution to the problem for the given input.
 //------------------------------------------------------------------------------
@@ -101,9 +176,11 @@ int Solve(std::vector<std::string> input, bool debug/* = false*/)
 {
 	Helper::PrintIf(debug, "\n==============================================================================");
 
-	// Turn the input into a map and get the guard's starting position.
+	// Turn the input into a map and get the guard's starting position and
+	// direction.
 	Map map(input.size(), input[0].length());
-	GridPosition guard;
+	GridPosition guard     = {0, 0};
+	Direction    direction = Direction::North;
 	for (size_t lineIndex = 0; lineIndex < input.size(); ++lineIndex)
 	{
 		for (size_t charIndex = 0; charIndex < input[0].length(); ++charIndex)
@@ -112,29 +189,37 @@ int Solve(std::vector<std::string> input, bool debug/* = false*/)
 			map[lineIndex][charIndex] = c;
 			if (c == '^' || c == '>' || c == 'v' || c == '<')
 			{
-				guard = {static_cast<int>(lineIndex), static_cast<int>(charIndex)};
+				guard     = {static_cast<int>(lineIndex), static_cast<int>(charIndex)};
+				direction = c == '^' ? Direction::North :
+				            c == '>' ? Direction::East  :
+				            c == 'v' ? Direction::South :
+				                       Direction::West;
 			}
 		}
 	}
+	Helper::PrintIf(debug, "\n{}", map);
+
+	// Guard states only have room for maps up to a certain size. The largest
+	// row and column are kept free so a guard stepping off the top or left of
+	// the map always lands outside it.
+	REQUIRE(map.GetHeight() < GUARD_STATE_MAX_SIDE && map.GetWidth() < GUARD_STATE_MAX_SIDE,
+	        "Maps must be less than {} cells on each side!", GUARD_STATE_MAX_SIDE);
 
-	// Keep track of the movement history.
-	MovementHistory history;
-	// Keep track of valid obstacle positions.
-	ValidLocations validObstacles;
-	// Find all valid obstacle positions.
-	FindValidObstaclePositions(map, guard, history, validObstacles, debug);
+	// Walk the original path once to find every candidate obstacle position.
+	std::vector<Candidate> candidates = FindCandidates(map, PackGuardState(guard, direction));
+
+	// Check all the candidates in parallel.
+	unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<uint8_t> createsLoop = EvaluateCandidates(map, candidates, threadCount);
 
 	// Count the number of valid obstacle positions.
 	int total = 0;
-	for (size_t rowIndex = 0; rowIndex < map.GetHeight(); ++rowIndex)
+	for (size_t candidateIndex = 0; candidateIndex < candidates.size(); ++candidateIndex)
 	{
-		for (size_t colIndex = 0; colIndex < map.GetWidth(); ++colIndex)
+		if (createsLoop[candidateIndex])
 		{
-			GridPosition position = {static_cast<int>(rowIndex), static_cast<int>(colIndex)};
-			if (validObstacles[position])
-			{
-				total += 1;
-			}
+			Helper::PrintIf(debug, "\n{}Found a loop by placing an obstacle at {}{}", ANSIEscapeCodes::GREEN, candidates[candidateIndex].obstacle, ANSIEscapeCodes::RESET);
+			total += 1;
 		}
 	}
 
@@ -147,75 +232,50 @@ int Solve(std::vector<std::string> input, bool debug/* = false*/)
 
 
 //==============================================================================
-//		FindValidObstaclePositions - Finds and records all valid obstacle
-//		positions that will cause the guard to enter a loop.
+//		FindCandidates - Walks the guard's original path once and records every
+//		position on it where an obstacle could be placed, together with the
+//		guard's state just before reaching it.
 //------------------------------------------------------------------------------
-void FindValidObstaclePositions(Map&             map,
-                                GridPosition&    guard,
-                                MovementHistory& history,
-                                ValidLocations&  validObstacles,
-                                bool             debug)
+std::vector<Candidate> FindCandidates(const Map& map, GuardState guard)
 {
-	// Print the starting map.
-	Helper::PrintIf(debug, "\n{}", map);
+	std::vector<Candidate> candidates;
 
-	// Create copies of the parameters.
-	Map                 mapCopy = map;
-	GridPosition      guardCopy = guard;
-	MovementHistory historyCopy = history;
-
-	// Check if the next position is a valid position to place an obstacle.
-	GridPosition nextPosition = GetNextPosition(mapCopy, guardCopy);
-	if (mapCopy.WithinBounds(nextPosition) &&
-	    mapCopy[nextPosition] != '#'       &&
-	    mapCopy[nextPosition] != 'X'       &&
-	    !validObstacles[nextPosition])
-	{
-		Helper::PrintIf(debug, "\nAttempting to create a loop by placing an obstacle at {}", nextPosition);
+	// An obstacle can't go where the guard has already been, as that would
+	// have changed the path that led here. That includes the starting
+	// position.
+	std::vector<bool> visited(map.GetHeight() * map.GetWidth(), false);
+	visited[map.GetCellIndex(GetPosition(guard))] = true;
 
-		// Place the obstacle.
-		mapCopy[nextPosition] = '@';
+	while (true)
+	{
+		GuardState   next         = StepGuardState(guard);
+		GridPosition nextPosition = GetPosition(next);
 
-		// Simulate guard movement until a loop is found or the guard leaves the
-		// map.
-		bool loopFound = false;
-		while (!loopFound && Move(mapCopy, guardCopy, historyCopy, debug))
+		// The guard leaves the map.
+		if (!map.WithinBounds(nextPosition))
 		{
-			// Check for a loop.
-			if (historyCopy[{guardCopy, mapCopy[guardCopy]}])
-			{
-				loopFound = true;
-				validObstacles[nextPosition] = true;
-			}
+			break;
 		}
-
-		// Print the map after simulating guard movement in the map copy. Then
-		// print the results.
-		Helper::PrintIf(debug, "\n{}", mapCopy);
-		if (loopFound)
+		// The guard turns.
+		else if (map[nextPosition] == '#')
 		{
-			Helper::PrintIf(debug, "\n{}Found a loop!{}",  ANSIEscapeCodes::GREEN, ANSIEscapeCodes::RESET);
+			guard = TurnGuardState(guard);
 		}
+		// The guard moves forward. The first time they reach a position, it is
+		// a candidate.
 		else
 		{
-			Helper::PrintIf(debug, "\n{}No loop found!{}", ANSIEscapeCodes::RED,   ANSIEscapeCodes::RESET);
+			size_t cellIndex = map.GetCellIndex(nextPosition);
+			if (!visited[cellIndex])
+			{
+				visited[cellIndex] = true;
+				candidates.push_back({nextPosition, guard});
+			}
+			guard = next;
 		}
 	}
-	// Otherwise skip trying to place an obstacle.
-	else
-	{
-		Helper::PrintIf(debug, "\nThe next location is not a valid obstacle location!");
-	}
 
-	// Move one step in the original map and check if the guard has left the
-	// map.
-	bool guardLeft = !Move(map, guard, history, false);
-
-	// If we are still on the map, keep searching for valid obstacles locations.
-	if (!guardLeft)
-	{
-		FindValidObstaclePositions(map, guard, history, validObstacles, debug);
-	}
+	return candidates;
 }
 
 
@@ -223,47 +283,42 @@ void FindValidObstaclePositions(Map&             map,
 
 
 //==============================================================================
-//		Move - Simulates the given guard's movement in the given map. Records
-//		the movement history. Returns true if the guard remains on the map and
-//		false if they leave it.
+//		EvaluateCandidates - Checks every candidate on a pool of threads.
+//		Returns, for each candidate, whether placing its obstacle makes the
+//		guard loop.
 //------------------------------------------------------------------------------
-bool Move(Map& map, GridPosition& guard, MovementHistory& history, bool debug)
+std::vector<uint8_t> EvaluateCandidates(const Map&                    map,
+                                        const std::vector<Candidate>& candidates,
+                                        unsigned                      threadCount)
 {
-	// Get the current direction.
-	char currentDirection = map[guard];
-
-	// Record the current position and direction in the history.
-	history[{guard, currentDirection}] = true;
+	// Each result is written by exactly one thread, so a plain byte per
+	// candidate is enough (std::vector<bool> packs bits and isn't safe here).
+	std::vector<uint8_t> createsLoop(candidates.size(), 0);
 
-	// Figure out the new position and direction.
-	GridPosition nextPosition  = GetNextPosition (map, guard);
-	char         nextDirection = GetNextDirection(currentDirection);
-
-	// If the new position is not within bounds, the guard will leave the map
-	// this movement.
-	if (!map.WithinBounds(nextPosition))
+	// Workers pull the next unclaimed candidate until there are none left.
+	std::atomic<size_t> nextCandidate = 0;
+	auto worker = [&]()
 	{
-		// Mark the current position.
-		map[guard] = 'X';
-		return false;
-	}
-	// If the new position is not an obstacle, the guard will move forward.
-	else if (map[nextPosition] != '#' && map[nextPosition] != '@')
+		DirectionMaskGrid turns(map.GetHeight(), map.GetWidth());
+		for (size_t candidateIndex = nextCandidate++; candidateIndex < candidates.size(); candidateIndex = nextCandidate++)
+		{
+			createsLoop[candidateIndex] = CreatesLoop(map, candidates[candidateIndex], turns);
+		}
+	};
+
+	threadCount = std::min<size_t>(threadCount, std::max<size_t>(1, candidates.size()));
+	std::vector<std::thread> threads;
+	for (unsigned threadIndex = 1; threadIndex < threadCount; ++threadIndex)
 	{
-		// Move the guard.
-		map[guard] = 'X';
-		guard = nextPosition;
-		map[guard] = currentDirection;
+		threads.emplace_back(worker);
 	}
-	// Otherwise the guard will change directions.
-	else
+	worker();
+	for (std::thread& thread : threads)
 	{
-		// Rotate the guard
-		map[guard] = nextDirection;
-		Helper::PrintIf(debug, "\n{}", map);
+		thread.join();
 	}
 
-	return true;
+	return createsLoop;
 }
 
 
@@ -271,35 +326,56 @@ bool Move(Map& map, GridPosition& guard, MovementHistory& history, bool debug)
 
 
 //==============================================================================
-//		GetNextPosition - Returns the position in front of the guard.
+//		CreatesLoop - Simulates the guard's movement from the candidate's
+//		starting state with its obstacle in place. Returns true if the guard
+//		enters a loop and false if they leave the map.
 //------------------------------------------------------------------------------
-GridPosition GetNextPosition(const Map& map, const GridPosition& guard)
+bool CreatesLoop(const Map& map, const Candidate& candidate, DirectionMaskGrid& turns)
 {
-	GridPosition nextPosition;
+	turns.Clear();
 
-	char currentDirection = map[guard];
-	if (currentDirection == '^')
-	{
-		nextPosition  = {guard.rowIndex - 1, guard.colIndex};
-	}
-	else if (currentDirection == '>')
-	{
-		nextPosition  = {guard.rowIndex, guard.colIndex + 1};
-	}
-	else if (currentDirection == 'v')
-	{
-		nextPosition  = {guard.rowIndex + 1, guard.colIndex};
-	}
-	else if (currentDirection == '<')
+	GuardState guard = candidate.guard;
+	while (true)
 	{
-		nextPosition  = {guard.rowIndex, guard.colIndex - 1};
-	}
-	else
-	{
-		REQUIRE(false, "Invalid direction {}!", currentDirection);
+		GuardState   next         = StepGuardState(guard);
+		GridPosition nextPosition = GetPosition(next);
+
+		// The guard leaves the map.
+		if (!map.WithinBounds(nextPosition))
+		{
+			return false;
+		}
+		// The guard turns. Any loop has to contain a turn, so it is enough to
+		// only record the states where the guard turns.
+		else if (map[nextPosition] == '#' || nextPosition == candidate.obstacle)
+		{
+			if (turns.Visit(guard))
+			{
+				return true;
+			}
+			guard = TurnGuardState(guard);
+		}
+		// The guard moves forward.
+		else
+		{
+			guard = next;
+		}
 	}
+}
 
-	return nextPosition;
+
+
+
+
+//==============================================================================
+//		PackGuardState - Packs the given position and direction into a guard
+//		state.
+//------------------------------------------------------------------------------
+GuardState PackGuardState(const GridPosition& pos, Direction direction)
+{
+	return (static_cast<GuardState>(pos.rowIndex) << (GUARD_STATE_POSITION_BITS + GUARD_STATE_DIRECTION_BITS)) |
+	       (static_cast<GuardState>(pos.colIndex) <<  GUARD_STATE_DIRECTION_BITS)                              |
+	        static_cast<GuardState>(direction);
 }
 
 
@@ -307,35 +383,58 @@ GridPosition GetNextPosition(const Map& map, const GridPosition& guard)
 
 
 //==============================================================================
-//		GetNextDirection - Returns the direction the guard will face after
-//		rotating 90 degrees clockwise from the current direction.
+//		GetPosition - Returns the position stored in the given guard state.
 //------------------------------------------------------------------------------
-char GetNextDirection(char currentDirection)
+GridPosition GetPosition(GuardState state)
 {
-	char nextDirection;
+	GuardState positionMask = GUARD_STATE_MAX_SIDE - 1;
+	return {static_cast<int>((state >> (GUARD_STATE_POSITION_BITS + GUARD_STATE_DIRECTION_BITS)) & positionMask),
+	        static_cast<int>((state >>  GUARD_STATE_DIRECTION_BITS)                              & positionMask)};
+}
 
-	if (currentDirection == '^')
-	{
-		nextDirection = '>';
-	}
-	else if (currentDirection == '>')
-	{
-		nextDirection = 'v';
-	}
-	else if (currentDirection == 'v')
-	{
-		nextDirection = '<';
-	}
-	else if (currentDirection == '<')
-	{
-		nextDirection = '^';
-	}
-	else
-	{
-		REQUIRE(false, "Invalid direction {}!", currentDirection);
-	}
 
-	return nextDirection;
+
+
+
+//==============================================================================
+//		GetDirection - Returns the direction stored in the given guard state.
+//------------------------------------------------------------------------------
+Direction GetDirection(GuardState state)
+{
+	return static_cast<Direction>(state & ((1 << GUARD_STATE_DIRECTION_BITS) - 1));
+}
+
+
+
+
+
+//==============================================================================
+//		StepGuardState - Returns the state with the guard moved one cell
+//		forward. Moving is a single addition to the packed row or column
+//		field, indexed by direction.
+//------------------------------------------------------------------------------
+GuardState StepGuardState(GuardState state)
+{
+	constexpr GuardState ROW_STEP = GuardState(1) << (GUARD_STATE_POSITION_BITS + GUARD_STATE_DIRECTION_BITS);
+	constexpr GuardState COL_STEP = GuardState(1) <<  GUARD_STATE_DIRECTION_BITS;
+	constexpr GuardState STEPS[]  = {GuardState(0) - ROW_STEP, COL_STEP, ROW_STEP, GuardState(0) - COL_STEP};
+
+	return state + STEPS[state & ((1 << GUARD_STATE_DIRECTION_BITS) - 1)];
+}
+
+
+
+
+
+//==============================================================================
+//		TurnGuardState - Returns the state with the guard rotated 90 degrees
+//		clockwise.
+//------------------------------------------------------------------------------
+GuardState TurnGuardState(GuardState state)
+{
+	constexpr GuardState DIRECTION_MASK = (1 << GUARD_STATE_DIRECTION_BITS) - 1;
+
+	return (state & ~DIRECTION_MASK) | ((state + 1) & DIRECTION_MASK);
 }
 
 
@@ -367,24 +466,12 @@ struct std::formatter<Solution::Map, char>
 			for (size_t colIndex = 0; colIndex < map.GetWidth(); ++colIndex)
 			{
 				char c = map[rowIndex][colIndex];
-				if (c == '@')
-				{
-					result += ANSIEscapeCodes::YELLOW;
-					result += '#';
-					result += ANSIEscapeCodes::RESET;
-				}
-				else if (c == '#')
+				if (c == '#')
 				{
 					result += ANSIEscapeCodes::RED;
 					result += c;
 					result += ANSIEscapeCodes::RESET;
 				}
-				else if (c == 'X')
-				{
-					result += ANSIEscapeCodes::BLUE;
-					result += c;
-					result += ANSIEscapeCodes::RESET;
-				}
 				else if (c == '^' || c == '>' || c == 'v' || c == '<')
 				{
 					result += ANSIEscapeCodes::BOLD;
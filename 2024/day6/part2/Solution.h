@@ -16,8 +16,8 @@
 //------------------------------------------------------------------------------
 #include "Grid.h"
 
+#include <cstdint>
 #include <string>
-#include <map>
 #include <vector>
 
 
@@ -41,8 +41,45 @@ namespace Solution
 //==============================================================================
 //		Types
 //------------------------------------------------------------------------------
-typedef std::map<std::pair<GridPosition, char>, bool> MovementHistory;
-typedef std::map<GridPosition, bool>                  ValidLocations;
+enum class Direction
+{
+	North,
+	East,
+	South,
+	West,
+	NumberOfDirections
+};
+
+
+
+
+
+//==============================================================================
+//		GuardState - The guard's position and direction packed into 32 bits:
+//		the row in the top 15 bits, the column in the next 15 and the direction
+//		in the bottom 2. Stepping off the top or left of the map wraps a field
+//		round to its maximum, which is always outside the map.
+//------------------------------------------------------------------------------
+typedef uint32_t GuardState;
+
+constexpr int GUARD_STATE_DIRECTION_BITS = 2;
+constexpr int GUARD_STATE_POSITION_BITS  = 15;
+constexpr int GUARD_STATE_MAX_SIDE       = 1 << GUARD_STATE_POSITION_BITS;
+
+
+
+
+
+//==============================================================================
+//		Candidate - A position where an obstacle could be placed, along with
+//		the guard's state just before they would reach it on their original
+//		path.
+//------------------------------------------------------------------------------
+struct Candidate
+{
+	GridPosition obstacle;
+	GuardState   guard;
+};
 
 
 
@@ -57,6 +94,33 @@ public:
 	                                        Map(size_t height, size_t width);
 	                                        Map(const std::vector<std::vector<char>>& grid);
 	                                        Map(std::vector<std::vector<char>>&& grid);
+
+	size_t                                  GetCellIndex(const GridPosition& pos) const;
+};
+
+
+
+
+
+//==============================================================================
+//		DirectionMaskGrid - Per-thread record of the (position, direction)
+//		states a guard has turned in, as a 4-bit direction mask per cell packed
+//		two cells to a byte. Keeps an undo log of the bytes it has touched so
+//		clearing it only costs as much as the run that filled it.
+//------------------------------------------------------------------------------
+class DirectionMaskGrid
+{
+public:
+	                                        DirectionMaskGrid(size_t height, size_t width);
+
+	void                                    Clear();
+	bool                                    Visit(GuardState state);
+
+
+private:
+	size_t                                  mWidth;
+	std::vector<uint8_t>                    mMasks;
+	std::vector<uint32_t>                   mUndoLog;
 };
 
 
@@ -73,44 +137,83 @@ int Solve(std::vector<std::string> input, bool debug = false);
 
 
 //==============================================================================
-//		FindValidObstaclePositions - Finds and records all valid obstacle
-//		positions that will cause the guard to enter a loop.
+//		FindCandidates - Walks the guard's original path once and records every
+//		position on it where an obstacle could be placed, together with the
+//		guard's state just before reaching it.
+//------------------------------------------------------------------------------
+std::vector<Candidate> FindCandidates(const Map& map, GuardState guard);
+
+
+
+
+
+//==============================================================================
+//		EvaluateCandidates - Checks every candidate on a pool of threads.
+//		Returns, for each candidate, whether placing its obstacle makes the
+//		guard loop.
+//------------------------------------------------------------------------------
+std::vector<uint8_t> EvaluateCandidates(const Map&                    map,
+                                        const std::vector<Candidate>& candidates,
+                                        unsigned                      threadCount);
+
+
+
+
+
+//==============================================================================
+//		CreatesLoop - Simulates the guard's movement from the candidate's
+//		starting state with its obstacle in place. Returns true if the guard
+//		enters a loop and false if they leave the map.
+//------------------------------------------------------------------------------
+bool CreatesLoop(const Map& map, const Candidate& candidate, DirectionMaskGrid& turns);
+
+
+
+
+
+//==============================================================================
+//		PackGuardState - Packs the given position and direction into a guard
+//		state.
+//------------------------------------------------------------------------------
+GuardState PackGuardState(const GridPosition& pos, Direction direction);
+
+
+
+
+
+//==============================================================================
+//		GetPosition - Returns the position stored in the given guard state.
 //------------------------------------------------------------------------------
-void FindValidObstaclePositions(Map&             map,
-                                GridPosition&    guard,
-                                MovementHistory& history,
-                                ValidLocations&  validObstacles,
-                                bool             debug);
+GridPosition GetPosition(GuardState state);
 
 
 
 
 
 //==============================================================================
-//		Move - Simulates the given guard's movement in the given map. Records
-//		the movement history. Returns true if the guard remains on the map and
-//		false if they leave it.
+//		GetDirection - Returns the direction stored in the given guard state.
 //------------------------------------------------------------------------------
-bool Move(Map& map, GridPosition& guard, MovementHistory& history, bool debug);
+Direction GetDirection(GuardState state);
 
 
 
 
 
 //==============================================================================
-//		GetNextPosition - Returns the position in front of the guard.
+//		StepGuardState - Returns the state with the guard moved one cell
+//		forward.
 //------------------------------------------------------------------------------
-GridPosition GetNextPosition(const Map& map, const GridPosition& guard);
+GuardState StepGuardState(GuardState state);
 
 
 
 
 
 //==============================================================================
-//		GetNextDirection - Returns the direction the guard will face after
-//		rotating 90 degrees clockwise from the current direction.
+//		TurnGuardState - Returns the state with the guard rotated 90 degrees
+//		clockwise.
 //------------------------------------------------------------------------------
-char GetNextDirection(char currentDirection);
+GuardState TurnGuardState(GuardState state);
 
 
 
@@ -18,6 +18,7 @@
 #include "Helper.h"
 
 #include <filesystem>
+#include <limits>
 
 
 
@@ -61,44 +62,30 @@ namespace Solution
 
 
 //==============================================================================
-//		Solve - Returns the solution to the problem for the given input.
+//		Solve - Returns the solution to the problem for the given input. T is
+//		the type the values are parsed and summed in; use __int128 for inputs
+//		whose values or total don't fit in a long.
 //------------------------------------------------------------------------------
-long Solve(std::vector<std::string> input, bool debug/* = false*/)
+template <typename T>
+T Solve(std::vector<std::string> input, bool debug/* = false*/)
 {
 	Helper::PrintIf(debug, "\n==============================================================================");
 
 	// Convert the input into equations.
-	std::vector<Equation> equations;
-	for (std::string line : input)
+	std::vector<BasicEquation<T>> equations;
+	for (const std::string& line : input)
 	{
-		std::istringstream iss(line);
-		std::string token;
-
-		// Get the test value.
-		std::getline(iss, token, ':');
-		long testValue = std::stol(token);
-
-		// Consume the space after the colon.
-		iss.get();
-
-		// Get the operands.
-		std::vector<long> operands;
-		while (std::getline(iss, token, ' '))
-		{
-			operands.push_back(std::stol(token));
-		}
-
-		// Save the equation.
-		equations.push_back({testValue, operands});
+		equations.push_back(ParseEquation<T>(line));
 	}
 
 	// For each equation, check if it can be made true. If so, add its test
 	// value to the total.
-	long total = 0;
-	for (const Equation& equation : equations)
+	T total = 0;
+	for (const BasicEquation<T>& equation : equations)
 	{
-		if (CanBeMadeTrue(equation))
+		if (CanBeMadeTrue<T>(equation.testValue, equation.operands))
 		{
+			REQUIRE(total <= std::numeric_limits<T>::max() - equation.testValue, "Total is too large, solve with a wider type!");
 			total += equation.testValue;
 		}
 	}
@@ -107,42 +94,101 @@ long Solve(std::vector<std::string> input, bool debug/* = false*/)
 	return total;
 }
 
+template long     Solve<long>    (std::vector<std::string> input, bool debug);
+template __int128 Solve<__int128>(std::vector<std::string> input, bool debug);
+
+
+
+
+
+//==============================================================================
+//		ParseEquation - Converts a line of the input into an equation.
+//------------------------------------------------------------------------------
+template <typename T>
+BasicEquation<T> ParseEquation(const std::string& line)
+{
+	BasicEquation<T> equation = {0, {}};
+
+	// Digits are accumulated by hand since std::stol can't produce a T.
+	T    value     = 0;
+	bool hasDigits = false;
+	bool seenColon = false;
+	for (char c : line)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			REQUIRE(value <= (std::numeric_limits<T>::max() - (c - '0')) / 10, "Value in \"{}\" is too large!", line);
+			value     = value * 10 + (c - '0');
+			hasDigits = true;
+			continue;
+		}
+
+		// Any other character ends the current number.
+		if (hasDigits)
+		{
+			if (!seenColon)
+			{
+				equation.testValue = value;
+			}
+			else
+			{
+				equation.operands.push_back(value);
+			}
+		}
+		seenColon = seenColon || c == ':';
+		value     = 0;
+		hasDigits = false;
+	}
+	if (hasDigits)
+	{
+		equation.operands.push_back(value);
+	}
+
+	REQUIRE(seenColon && !equation.operands.empty(), "Invalid equation \"{}\"!", line);
+	return equation;
+}
+
 
 
 
 
 //==============================================================================
-//		CanBeMadeTrue - Checks whether the given equation can be made true.
+//		CanBeMadeTrue - Checks whether the operands can be combined into the
+//		target using + and *, working backwards from the last operand.
 //------------------------------------------------------------------------------
-bool CanBeMadeTrue(const Equation& equation)
+template <typename T>
+bool CanBeMadeTrue(T target, std::span<const T> operands)
 {
-	// If there is just one operand left, check if it equals the test value.
-	if (equation.operands.size() == 1)
+	// If there is just one operand left, check if it equals the target.
+	if (operands.size() == 1)
+	{
+		return target == operands[0];
+	}
+
+	// Otherwise, undo the last operator. Every way of doing so shrinks the
+	// target, so nothing here can overflow.
+	T                  last      = operands.back();
+	std::span<const T> remaining = operands.first(operands.size() - 1);
+
+	// The plus operator is only possible if the last operand fits in the
+	// target.
+	if (target >= last && CanBeMadeTrue<T>(target - last, remaining))
+	{
+		return true;
+	}
+
+	// The times operator is only possible if the last operand divides the
+	// target.
+	if (last != 0 && target % last == 0 && CanBeMadeTrue<T>(target / last, remaining))
+	{
+		return true;
+	}
+	if (last == 0 && target == 0)
 	{
-		return equation.testValue == equation.operands[0];
+		return true;
 	}
 
-	// Otherwise, there is more work to be done. Get the relevant values from
-	// the equation.
-	long testValue = equation.testValue;
-	long operand1  = equation.operands[0];
-	long operand2  = equation.operands[1];
-
-	// Use the plus operator to combine the first two operands. Create a new
-	// operands list for this operator.
-	long newOperandPlus = operand1 + operand2;
-	std::vector<long> newOperandsPlus = {newOperandPlus};
-	newOperandsPlus.insert(newOperandsPlus.end(), equation.operands.begin() + 2, equation.operands.end());
-
-	// Use the times operator to combine the first two operands. Create a new
-	// operands list for this operator.
-	long newOperandMultiply = operand1 * operand2;
-	std::vector<long> newOperandsMultiply = {newOperandMultiply};
-	newOperandsMultiply.insert(newOperandsMultiply.end(), equation.operands.begin() + 2, equation.operands.end());
-
-	// Check if the equation can be made true by using either of the two
-	// operators.
-	return CanBeMadeTrue({testValue, newOperandsPlus}) || CanBeMadeTrue({testValue, newOperandsMultiply});
+	return false;
 }
 
 
@@ -14,6 +14,7 @@
 //==============================================================================
 //		Includes
 //------------------------------------------------------------------------------
+#include <span>
 #include <string>
 #include <vector>
 
@@ -33,10 +34,11 @@ int main();
 //==============================================================================
 //		Types
 //------------------------------------------------------------------------------
-struct Equation
+template <typename T>
+struct BasicEquation
 {
-	long testValue;
-	std::vector<long> operands;
+	T testValue;
+	std::vector<T> operands;
 };
 
 
@@ -49,18 +51,33 @@ namespace Solution
 
 
 //==============================================================================
-//		Solve - Returns the solution to the problem for the given input.
+//		Solve - Returns the solution to the problem for the given input. T is
+//		the type the values are parsed and summed in; use __int128 for inputs
+//		whose values or total don't fit in a long.
 //------------------------------------------------------------------------------
-long Solve(std::vector<std::string> input, bool debug = false);
+template <typename T = long>
+T Solve(std::vector<std::string> input, bool debug = false);
 
 
 
 
 
 //==============================================================================
-//		CanBeMadeTrue - Checks whether the given equation can be made true.
+//		ParseEquation - Converts a line of the input into an equation.
 //------------------------------------------------------------------------------
-bool CanBeMadeTrue(const Equation& equation);
+template <typename T>
+BasicEquation<T> ParseEquation(const std::string& line);
+
+
+
+
+
+//==============================================================================
+//		CanBeMadeTrue - Checks whether the operands can be combined into the
+//		target using + and *, working backwards from the last operand.
+//------------------------------------------------------------------------------
+template <typename T>
+bool CanBeMadeTrue(T target, std::span<const T> operands);
 
 
 
@@ -17,7 +17,15 @@
 #include "ANSIEscapeCodes.h"
 #include "Helper.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
+#include <limits>
+#include <numeric>
+#include <thread>
 
 
 
@@ -49,6 +57,70 @@ int main()
 	}
 
 	std::cout << std::endl;
+
+	// The values and total here don't fit in a long, so they have to be solved
+	// in 128 bits.
+	std::cout << ANSIEscapeCodes::BOLD << "Wide Example Solution: " << ANSIEscapeCodes::RESET;
+	std::vector<std::string> wideInput = {"18446744073709551616: 4294967296 4294967296", "92233720368547758079: 9223372036854775807 9", "100: 10 0"};
+	std::cout << Helper::ToString(Solution::Solve<__int128>(wideInput)) << ANSIEscapeCodes::ITALIC << " (expected 110680464442257309795)" << ANSIEscapeCodes::RESET << std::endl;
+
+	std::cout << std::endl;
+}
+
+
+
+
+
+//==============================================================================
+//		WorkStealingDeque::Push(const Task& task)
+//------------------------------------------------------------------------------
+template <typename Task>
+void WorkStealingDeque<Task>::Push(const Task& task)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mTasks.push_back(task);
+}
+
+
+
+
+
+//==============================================================================
+//		WorkStealingDeque::Pop(Task& task) - Takes a task from the back. Returns
+//		false if there are none left.
+//------------------------------------------------------------------------------
+template <typename Task>
+bool WorkStealingDeque<Task>::Pop(Task& task)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mTasks.empty())
+	{
+		return false;
+	}
+	task = mTasks.back();
+	mTasks.pop_back();
+	return true;
+}
+
+
+
+
+
+//==============================================================================
+//		WorkStealingDeque::Steal(Task& task) - Takes a task from the front.
+//		Returns false if there are none left.
+//------------------------------------------------------------------------------
+template <typename Task>
+bool WorkStealingDeque<Task>::Steal(Task& task)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mTasks.empty())
+	{
+		return false;
+	}
+	task = mTasks.front();
+	mTasks.pop_front();
+	return true;
 }
 
 
@@ -61,50 +133,164 @@ namespace Solution
 
 
 //==============================================================================
-//		Solve - Returns the solution to the problem for the given input.
+//		Solve - Returns the solution to the problem for the given input. T is
+//		the type the values are parsed and summed in; use __int128 for inputs
+//		whose values or total don't fit in a long.
 //------------------------------------------------------------------------------
-long Solve(std::vector<std::string> input, bool debug/* = false*/)
+template <typename T>
+T Solve(std::vector<std::string> input, bool debug/* = false*/)
 {
 	Helper::PrintIf(debug, "\n==============================================================================");
 
 	// Convert the input into equations.
-	std::vector<Equation> equations;
-	for (std::string line : input)
+	std::vector<BasicEquation<T>> equations;
+	for (const std::string& line : input)
+	{
+		equations.push_back(ParseEquation<T>(line));
+	}
+
+	// Check all the equations in parallel. For each one that can be made true,
+	// add its test value to the total.
+	unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<uint8_t> canBeMadeTrue = SolveBatch(equations, threadCount, debug);
+
+	T total = 0;
+	for (size_t equationIndex = 0; equationIndex < equations.size(); ++equationIndex)
+	{
+		if (canBeMadeTrue[equationIndex])
+		{
+			REQUIRE(total <= std::numeric_limits<T>::max() - equations[equationIndex].testValue, "Total is too large, solve with a wider type!");
+			total += equations[equationIndex].testValue;
+		}
+	}
+
+	Helper::PrintIf(debug,   "------------------------------------------------------------------------------");
+	return total;
+}
+
+template long     Solve<long>    (std::vector<std::string> input, bool debug);
+template __int128 Solve<__int128>(std::vector<std::string> input, bool debug);
+
+
+
+
+
+//==============================================================================
+//		SolveBatch - Checks every equation on a pool of work-stealing threads.
+//		Returns, for each equation, whether it can be made true. When debugging,
+//		also times every task and reports the equations that took the longest;
+//		otherwise no timing is done.
+//------------------------------------------------------------------------------
+template <typename T>
+std::vector<uint8_t> SolveBatch(const std::vector<BasicEquation<T>>& equations,
+                                unsigned                             threadCount,
+                                bool                                 debug)
+{
+	// Order the equations from cheapest to most expensive, and break the
+	// expensive ones up into subtasks.
+	std::vector<size_t> order(equations.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs)
 	{
-		std::istringstream iss(line);
-		std::string token;
+		return equations[lhs].operands.size() < equations[rhs].operands.size();
+	});
 
-		// Get the test value.
-		std::getline(iss, token, ':');
-		long testValue = std::stol(token);
+	std::vector<EquationTask<T>> tasks;
+	for (size_t equationIndex : order)
+	{
+		const BasicEquation<T>& equation = equations[equationIndex];
+		SplitTask(equation, {equationIndex, equation.testValue, equation.operands.size()}, 0, tasks);
+	}
 
-		// Consume the space after the colon.
-		iss.get();
+	// Deal the tasks out to the workers. The owner pops from the back, so each
+	// worker starts with its most expensive tasks and thieves take the cheap
+	// ones from the front.
+	threadCount = std::min<size_t>(threadCount, std::max<size_t>(1, tasks.size()));
+	std::vector<WorkStealingDeque<EquationTask<T>>> deques(threadCount);
+	for (size_t taskIndex = 0; taskIndex < tasks.size(); ++taskIndex)
+	{
+		deques[taskIndex % threadCount].Push(tasks[taskIndex]);
+	}
 
-		// Get the operands.
-		std::vector<long> operands;
-		while (std::getline(iss, token, ' '))
+	// Once one subtask of an equation succeeds, the rest can be skipped.
+	std::vector<std::atomic<uint8_t>> solved     (equations.size());
+	std::vector<std::atomic<long>>    nanoseconds(equations.size());
+
+	auto worker = [&](unsigned workerIndex)
+	{
+		EquationTask<T> task;
+		while (true)
 		{
-			operands.push_back(std::stol(token));
+			// Take our own work first, then look for some to steal. No new
+			// tasks are created once the workers start, so if every deque is
+			// empty we're done.
+			bool found = deques[workerIndex].Pop(task);
+			for (unsigned offset = 1; !found && offset < threadCount; ++offset)
+			{
+				found = deques[(workerIndex + offset) % threadCount].Steal(task);
+			}
+			if (!found)
+			{
+				return;
+			}
+
+			if (solved[task.equationIndex])
+			{
+				continue;
+			}
+
+			// The timing is only for the debug report. It stays compiled into
+			// the loop, but when debugging is off all it costs is a branch that
+			// always goes the same way.
+			std::chrono::steady_clock::time_point start;
+			if (debug)
+			{
+				start = std::chrono::steady_clock::now();
+			}
+
+			std::span<const T> operands(equations[task.equationIndex].operands.data(), task.operandCount);
+			if (CanBeMadeTrue<T>(task.target, operands))
+			{
+				solved[task.equationIndex] = 1;
+			}
+
+			if (debug)
+			{
+				std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+				nanoseconds[task.equationIndex] += elapsed.count();
+			}
 		}
+	};
 
-		// Save the equation.
-		equations.push_back({testValue, operands});
+	std::vector<std::thread> threads;
+	for (unsigned threadIndex = 1; threadIndex < threadCount; ++threadIndex)
+	{
+		threads.emplace_back(worker, threadIndex);
+	}
+	worker(0);
+	for (std::thread& thread : threads)
+	{
+		thread.join();
 	}
 
-	// For each equation, check if it can be made true. If so, add its test
-	// value to the total.
-	long total = 0;
-	for (const Equation& equation : equations)
+	// Report the worst offenders.
+	if (debug)
 	{
-		if (CanBeMadeTrue(equation))
+		std::vector<size_t> slowest(equations.size());
+		std::iota(slowest.begin(), slowest.end(), 0);
+		size_t reportCount = std::min<size_t>(WORST_OFFENDER_COUNT, slowest.size());
+		std::partial_sort(slowest.begin(), slowest.begin() + reportCount, slowest.end(), [&](size_t lhs, size_t rhs)
+		{
+			return nanoseconds[lhs] > nanoseconds[rhs];
+		});
+		for (size_t rank = 0; rank < reportCount; ++rank)
 		{
-			total += equation.testValue;
+			size_t equationIndex = slowest[rank];
+			Helper::Print("Equation {} ({} operands) took {}us", equationIndex, equations[equationIndex].operands.size(), nanoseconds[equationIndex] / 1000);
 		}
 	}
 
-	Helper::PrintIf(debug,   "------------------------------------------------------------------------------");
-	return total;
+	return std::vector<uint8_t>(solved.begin(), solved.end());
 }
 
 
@@ -112,44 +298,186 @@ long Solve(std::vector<std::string> input, bool debug/* = false*/)
 
 
 //==============================================================================
-//		CanBeMadeTrue - Checks whether the given equation can be made true.
+//		SplitTask - Adds the given task to the list, first splitting it into
+//		subtasks (one per surviving choice of its last operator) if it is
+//		expensive enough.
 //------------------------------------------------------------------------------
-bool CanBeMadeTrue(const Equation& equation)
+template <typename T>
+void SplitTask(const BasicEquation<T>&       equation,
+               const EquationTask<T>&        task,
+               size_t                        depth,
+               std::vector<EquationTask<T>>& tasks)
 {
-	// If there is just one operand left, check if it equals the test value.
-	if (equation.operands.size() == 1)
-	{
-		return equation.testValue == equation.operands[0];
-	}
-
-	// Otherwise, there is more work to be done. Get the relevant values from
-	// the equation.
-	long testValue = equation.testValue;
-	long operand1  = equation.operands[0];
-	long operand2  = equation.operands[1];
-
-	// Use the plus operator to combine the first two operands. Create a new
-	// operands list for this operator.
-	long newOperandPlus = operand1 + operand2;
-	std::vector<long> newOperandsPlus = {newOperandPlus};
-	newOperandsPlus.insert(newOperandsPlus.end(), equation.operands.begin() + 2, equation.operands.end());
-
-	// Use the times operator to combine the first two operands. Create a new
-	// operands list for this operator.
-	long newOperandMultiply = operand1 * operand2;
-	std::vector<long> newOperandsMultiply = {newOperandMultiply};
-	newOperandsMultiply.insert(newOperandsMultiply.end(), equation.operands.begin() + 2, equation.operands.end());
-
-	// Use the concatenation operator to combine the first two operands. Create
-	// a new operands list for this operator.
-	long newOperandConcatenation = std::stol(std::to_string(operand1) + std::to_string(operand2));
-	std::vector<long> newOperandsConcatenation = {newOperandConcatenation};
-	newOperandsConcatenation.insert(newOperandsConcatenation.end(), equation.operands.begin() + 2, equation.operands.end());
-
-	// Check if the equation can be made true using any of the operators.
-	return CanBeMadeTrue({testValue, newOperandsPlus})     ||
-	       CanBeMadeTrue({testValue, newOperandsMultiply}) ||
-	       CanBeMadeTrue({testValue, newOperandsConcatenation});
+	// Anything times zero is zero, so a zero operand can't be split on.
+	T last = equation.operands[task.operandCount - 1];
+	if (EstimateCost(task.operandCount) <= SPLIT_COST || depth == MAX_SPLIT_DEPTH || last == 0)
+	{
+		tasks.push_back(task);
+		return;
+	}
+
+	// Fix the last operator each possible way, using the same pruning as
+	// CanBeMadeTrue. Choices that can't work produce no subtask at all.
+	T      target = task.target;
+	size_t count  = task.operandCount - 1;
+
+	if (target >= last)
+	{
+		SplitTask(equation, {task.equationIndex, target - last, count}, depth + 1, tasks);
+	}
+	if (target % last == 0)
+	{
+		SplitTask(equation, {task.equationIndex, target / last, count}, depth + 1, tasks);
+	}
+	T powerOfTen = GetPowerOfTenAbove(last);
+	if (powerOfTen != 0 && target >= last && target % powerOfTen == last)
+	{
+		SplitTask(equation, {task.equationIndex, target / powerOfTen, count}, depth + 1, tasks);
+	}
+}
+
+
+
+
+
+//==============================================================================
+//		EstimateCost - Returns the number of operator combinations for the
+//		given number of operands.
+//------------------------------------------------------------------------------
+double EstimateCost(size_t operandCount)
+{
+	return std::pow(3.0, static_cast<double>(operandCount) - 1);
+}
+
+
+
+
+
+//==============================================================================
+//		ParseEquation - Converts a line of the input into an equation.
+//------------------------------------------------------------------------------
+template <typename T>
+BasicEquation<T> ParseEquation(const std::string& line)
+{
+	BasicEquation<T> equation = {0, {}};
+
+	// Digits are accumulated by hand since std::stol can't produce a T.
+	T    value     = 0;
+	bool hasDigits = false;
+	bool seenColon = false;
+	for (char c : line)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			REQUIRE(value <= (std::numeric_limits<T>::max() - (c - '0')) / 10, "Value in \"{}\" is too large!", line);
+			value     = value * 10 + (c - '0');
+			hasDigits = true;
+			continue;
+		}
+
+		// Any other character ends the current number.
+		if (hasDigits)
+		{
+			if (!seenColon)
+			{
+				equation.testValue = value;
+			}
+			else
+			{
+				equation.operands.push_back(value);
+			}
+		}
+		seenColon = seenColon || c == ':';
+		value     = 0;
+		hasDigits = false;
+	}
+	if (hasDigits)
+	{
+		equation.operands.push_back(value);
+	}
+
+	REQUIRE(seenColon && !equation.operands.empty(), "Invalid equation \"{}\"!", line);
+	return equation;
+}
+
+
+
+
+
+//==============================================================================
+//		CanBeMadeTrue - Checks whether the operands can be combined into the
+//		target using +, * and ||, working backwards from the last operand.
+//------------------------------------------------------------------------------
+template <typename T>
+bool CanBeMadeTrue(T target, std::span<const T> operands)
+{
+	// If there is just one operand left, check if it equals the target.
+	if (operands.size() == 1)
+	{
+		return target == operands[0];
+	}
+
+	// Otherwise, undo the last operator. Every way of doing so shrinks the
+	// target, so nothing here can overflow.
+	T                  last      = operands.back();
+	std::span<const T> remaining = operands.first(operands.size() - 1);
+
+	// The plus operator is only possible if the last operand fits in the
+	// target.
+	if (target >= last && CanBeMadeTrue<T>(target - last, remaining))
+	{
+		return true;
+	}
+
+	// The times operator is only possible if the last operand divides the
+	// target.
+	if (last != 0 && target % last == 0 && CanBeMadeTrue<T>(target / last, remaining))
+	{
+		return true;
+	}
+	if (last == 0 && target == 0)
+	{
+		return true;
+	}
+
+	// The concatenation operator is only possible if the target ends with the
+	// digits of the last operand.
+	T powerOfTen = GetPowerOfTenAbove(last);
+	if (powerOfTen != 0 && target >= last && target % powerOfTen == last && CanBeMadeTrue<T>(target / powerOfTen, remaining))
+	{
+		return true;
+	}
+
+	return false;
+}
+
+
+
+
+
+//==============================================================================
+//		GetPowerOfTenAbove - Returns the smallest power of ten greater than the
+//		given value, or 0 if it doesn't fit in T. 0 gives 10, as it has one
+//		digit.
+//------------------------------------------------------------------------------
+template <typename T>
+T GetPowerOfTenAbove(T value)
+{
+	// 10^1 up to the largest power of ten that fits in T.
+	static constexpr std::array<T, std::numeric_limits<T>::digits10> powersOfTen = []()
+	{
+		std::array<T, std::numeric_limits<T>::digits10> powers{};
+		T power = 10;
+		for (T& entry : powers)
+		{
+			entry  = power;
+			power *= (&entry == &powers.back()) ? 1 : 10;
+		}
+		return powers;
+	}();
+
+	auto it = std::upper_bound(powersOfTen.begin(), powersOfTen.end(), value);
+	return it == powersOfTen.end() ? 0 : *it;
 }
 
 
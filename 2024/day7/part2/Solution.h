@@ -14,6 +14,9 @@
 //==============================================================================
 //		Includes
 //------------------------------------------------------------------------------
+#include <deque>
+#include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -33,10 +36,51 @@ int main();
 //==============================================================================
 //		Types
 //------------------------------------------------------------------------------
-struct Equation
+template <typename T>
+struct BasicEquation
 {
-	long testValue;
-	std::vector<long> operands;
+	T testValue;
+	std::vector<T> operands;
+};
+
+
+
+
+
+//==============================================================================
+//		EquationTask - A piece of work for the batch solver: can the first
+//		operandCount operands of the given equation be made to equal target?
+//		Expensive equations are split into several of these by fixing their
+//		last few operators up front.
+//------------------------------------------------------------------------------
+template <typename T>
+struct EquationTask
+{
+	size_t equationIndex;
+	T      target;
+	size_t operandCount;
+};
+
+
+
+
+
+//==============================================================================
+//		WorkStealingDeque - A queue of tasks owned by one worker. The owner
+//		takes tasks from the back, and idle workers steal from the front.
+//------------------------------------------------------------------------------
+template <typename Task>
+class WorkStealingDeque
+{
+public:
+	void                                    Push(const Task& task);
+	bool                                    Pop(Task& task);
+	bool                                    Steal(Task& task);
+
+
+private:
+	std::mutex                              mMutex;
+	std::deque<Task>                        mTasks;
 };
 
 
@@ -49,18 +93,96 @@ namespace Solution
 
 
 //==============================================================================
-//		Solve - Returns the solution to the problem for the given input.
+//		Constants
+//------------------------------------------------------------------------------
+constexpr double SPLIT_COST           = 19683.0; // 3^9
+constexpr size_t MAX_SPLIT_DEPTH      = 4;
+constexpr size_t WORST_OFFENDER_COUNT = 5;
+
+
+
+
+
+//==============================================================================
+//		Solve - Returns the solution to the problem for the given input. T is
+//		the type the values are parsed and summed in; use __int128 for inputs
+//		whose values or total don't fit in a long.
+//------------------------------------------------------------------------------
+template <typename T = long>
+T Solve(std::vector<std::string> input, bool debug = false);
+
+
+
+
+
+//==============================================================================
+//		SolveBatch - Checks every equation on a pool of work-stealing threads.
+//		Returns, for each equation, whether it can be made true. When debugging,
+//		also times every task and reports the equations that took the longest;
+//		otherwise no timing is done.
+//------------------------------------------------------------------------------
+template <typename T>
+std::vector<uint8_t> SolveBatch(const std::vector<BasicEquation<T>>& equations,
+                                unsigned                             threadCount,
+                                bool                                 debug);
+
+
+
+
+
+//==============================================================================
+//		SplitTask - Adds the given task to the list, first splitting it into
+//		subtasks (one per surviving choice of its last operator) if it is
+//		expensive enough.
+//------------------------------------------------------------------------------
+template <typename T>
+void SplitTask(const BasicEquation<T>&       equation,
+               const EquationTask<T>&        task,
+               size_t                        depth,
+               std::vector<EquationTask<T>>& tasks);
+
+
+
+
+
+//==============================================================================
+//		EstimateCost - Returns the number of operator combinations for the
+//		given number of operands.
+//------------------------------------------------------------------------------
+double EstimateCost(size_t operandCount);
+
+
+
+
+
+//==============================================================================
+//		ParseEquation - Converts a line of the input into an equation.
+//------------------------------------------------------------------------------
+template <typename T>
+BasicEquation<T> ParseEquation(const std::string& line);
+
+
+
+
+
+//==============================================================================
+//		CanBeMadeTrue - Checks whether the operands can be combined into the
+//		target using +, * and ||, working backwards from the last operand.
 //------------------------------------------------------------------------------
-long Solve(std::vector<std::string> input, bool debug = false);
+template <typename T>
+bool CanBeMadeTrue(T target, std::span<const T> operands);
 
 
 
 
 
 //==============================================================================
-//		CanBeMadeTrue - Checks whether the given equation can be made true.
+//		GetPowerOfTenAbove - Returns the smallest power of ten greater than the
+//		given value, or 0 if it doesn't fit in T. 0 gives 10, as it has one
+//		digit.
 //------------------------------------------------------------------------------
-bool CanBeMadeTrue(const Equation& equation);
+template <typename T>
+T GetPowerOfTenAbove(T value);
 
 
 
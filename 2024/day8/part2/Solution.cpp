@@ -15,12 +15,13 @@
 #include "Solution.h"
 
 #include "ANSIEscapeCodes.h"
-#include "Grid.h"
 #include "Helper.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
-#include <map>
-#include <set>
+#include <mutex>
+#include <thread>
 
 
 
@@ -70,83 +71,163 @@ int Solve(std::vector<std::string> input, bool debug/* = false*/)
 {
 	Helper::PrintIf(debug, "\n==============================================================================");
 
-	// Convert the input into a grid.
-	Grid grid(input.size(), input[0].length(), '.');
-	for (size_t rowIndex = 0; rowIndex < input.size(); ++rowIndex)
+	// Find the antennas of every frequency.
+	AntennaMap map = ParseAntennas(input);
+
+	// Count the number of unique antinode positions.
+	unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+	int total = static_cast<int>(CountAntinodes(map, threadCount, debug));
+
+	Helper::PrintIf(debug,   "------------------------------------------------------------------------------");
+	return total;
+}
+
+
+
+
+
+//==============================================================================
+//		ParseAntennas - Converts the input into an antenna map.
+//------------------------------------------------------------------------------
+AntennaMap ParseAntennas(const std::vector<std::string>& input)
+{
+	AntennaMap map = {input.size(), input[0].length(), {}, std::vector<size_t>(257, 0)};
+
+	// Count the antennas of each frequency. The counts are stored one slot
+	// along so that the running sum below turns them into start offsets.
+	for (const std::string& line : input)
 	{
-		for (size_t colIndex = 0; colIndex < input[0].length(); ++colIndex)
+		for (char c : line)
 		{
-			grid[rowIndex][colIndex] = input[rowIndex][colIndex];
+			if (c != '.')
+			{
+				map.bucketStarts[static_cast<unsigned char>(c) + 1] += 1;
+			}
 		}
 	}
+	for (size_t frequency = 1; frequency < map.bucketStarts.size(); ++frequency)
+	{
+		map.bucketStarts[frequency] += map.bucketStarts[frequency - 1];
+	}
 
-	// Find all the different frequencies and the positions of their antennas.
-	std::set<char> frequencies;
-	std::map<char, std::vector<GridPosition>> antennaPositions;
-	for (size_t rowIndex = 0; rowIndex < grid.GetHeight(); ++rowIndex)
+	// Place each antenna in its frequency's bucket.
+	map.antennas.resize(map.bucketStarts.back());
+	std::vector<size_t> next(map.bucketStarts.begin(), map.bucketStarts.end() - 1);
+	for (size_t rowIndex = 0; rowIndex < input.size(); ++rowIndex)
 	{
-		for (size_t colIndex = 0; colIndex < grid.GetWidth(); ++colIndex)
+		for (size_t colIndex = 0; colIndex < input[rowIndex].length(); ++colIndex)
 		{
-			char c = grid[rowIndex][colIndex];
+			char c = input[rowIndex][colIndex];
 			if (c != '.')
 			{
-				frequencies.insert(c);
-				antennaPositions[c].push_back({rowIndex, colIndex});
-
-				// Each antenna is also an antinode due to resonant harmonics.
-				// Mark it as such.
-				grid[rowIndex][colIndex] = '#';
+				map.antennas[next[static_cast<unsigned char>(c)]++] = {rowIndex, colIndex};
 			}
 		}
 	}
 
-	// For each frequency...
-	for (char frequency : frequencies)
+	return map;
+}
+
+
+
+
+
+//==============================================================================
+//		CountAntinodes - Returns the number of unique antinode positions,
+//		processing the frequencies in parallel.
+//------------------------------------------------------------------------------
+size_t CountAntinodes(const AntennaMap& map, unsigned threadCount, bool debug)
+{
+	// Each worker collects the antinodes of the frequencies it claims into its
+	// own set, which are then merged.
+	std::unordered_set<uint64_t> antinodes;
+	std::mutex                   antinodesMutex;
+	std::atomic<unsigned>        nextFrequency = 0;
+
+	auto worker = [&]()
 	{
-		// ...and for each pair of antenna positions of that frequency...
-		for (GridPosition antenna1 : antennaPositions[frequency])
+		std::unordered_set<uint64_t> localAntinodes;
+		for (unsigned frequency = nextFrequency++; frequency < 256; frequency = nextFrequency++)
 		{
-			for (GridPosition antenna2 : antennaPositions[frequency])
-			{
-				// ...if the antenna positions are different...
-				if (antenna1 != antenna2)
-				{
-					// ... calculate the delta from antenna1 to antenna2.
-					int rowDelta = antenna2.rowIndex - antenna1.rowIndex;
-					int colDelta = antenna2.colIndex - antenna1.colIndex;
-
-					// The first antinode is at the position antenna2 + delta.
-					GridPosition antinode = {antenna2.rowIndex + rowDelta, antenna2.colIndex + colDelta};
-
-					// While the antinode is within the grid, mark it and find
-					// the next antinode by following the delta.
-					while (grid.WithinBounds(antinode))
-					{
-						grid[antinode] = '#';
-						antinode = {antinode.rowIndex + rowDelta, antinode.colIndex + colDelta};
-					}
-				}
-
-			}
+			FindAntinodes(map, static_cast<unsigned char>(frequency), localAntinodes);
 		}
+
+		std::lock_guard<std::mutex> lock(antinodesMutex);
+		antinodes.merge(localAntinodes);
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned threadIndex = 1; threadIndex < threadCount; ++threadIndex)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
 	}
-	Helper::PrintIf(debug, "{}", grid);
 
-	// Count the number of unique antinode positions.
-	int total = 0;
-	for (size_t rowIndex = 0; rowIndex < grid.GetHeight(); ++rowIndex)
+	if (debug)
 	{
-		for (size_t colIndex = 0; colIndex < grid.GetWidth(); ++colIndex)
+		for (uint64_t antinode : antinodes)
 		{
-			if (grid[rowIndex][colIndex] == '#')
-			{
-				total += 1;
-			}
+			Helper::Print("{}", GridPosition(static_cast<size_t>(antinode / map.width), static_cast<size_t>(antinode % map.width)));
 		}
 	}
 
-	Helper::PrintIf(debug,   "------------------------------------------------------------------------------");
-	return total;
+	return antinodes.size();
+}
+
+
+
+
+
+//==============================================================================
+//		FindAntinodes - Adds the linear index of every antinode produced by the
+//		given frequency's antennas to the set.
+//------------------------------------------------------------------------------
+void FindAntinodes(const AntennaMap& map, unsigned char frequency, std::unordered_set<uint64_t>& antinodes)
+{
+	// Adds the position to the set if it is on the map. Returns whether it
+	// was.
+	auto addIfWithinBounds = [&](long rowIndex, long colIndex)
+	{
+		if (rowIndex < 0 || rowIndex >= static_cast<long>(map.height) ||
+		    colIndex < 0 || colIndex >= static_cast<long>(map.width))
+		{
+			return false;
+		}
+		antinodes.insert(static_cast<uint64_t>(rowIndex) * map.width + static_cast<uint64_t>(colIndex));
+		return true;
+	};
+
+	// Visit each unordered pair of antennas once.
+	size_t begin = map.bucketStarts[frequency];
+	size_t end   = map.bucketStarts[frequency + 1];
+	for (size_t i = begin; i < end; ++i)
+	{
+		const GridPosition& antenna1 = map.antennas[i];
+		// Each antenna is also an antinode due to resonant harmonics.
+		addIfWithinBounds(antenna1.rowIndex, antenna1.colIndex);
+
+		for (size_t j = i + 1; j < end; ++j)
+		{
+			const GridPosition& antenna2 = map.antennas[j];
+
+			// Calculate the delta from antenna1 to antenna2.
+			int rowDelta = antenna2.rowIndex - antenna1.rowIndex;
+			int colDelta = antenna2.colIndex - antenna1.colIndex;
+
+			// Follow the delta away from antenna2, and the negated delta away
+			// from antenna1, until leaving the map.
+			for (GridPosition antinode = {antenna2.rowIndex + rowDelta, antenna2.colIndex + colDelta};
+			     addIfWithinBounds(antinode.rowIndex, antinode.colIndex);
+			     antinode = {antinode.rowIndex + rowDelta, antinode.colIndex + colDelta});
+			for (GridPosition antinode = {antenna1.rowIndex - rowDelta, antenna1.colIndex - colDelta};
+			     addIfWithinBounds(antinode.rowIndex, antinode.colIndex);
+			     antinode = {antinode.rowIndex - rowDelta, antinode.colIndex - colDelta});
+		}
+	}
 }
 
 
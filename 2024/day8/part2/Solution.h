@@ -14,7 +14,11 @@
 //==============================================================================
 //		Includes
 //------------------------------------------------------------------------------
+#include "Grid.h"
+
+#include <cstdint>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 
@@ -35,6 +39,23 @@ namespace Solution
 
 
 
+//==============================================================================
+//		AntennaMap - The size of the map and the positions of its antennas,
+//		bucketed by frequency into one flat array. The antennas of frequency c
+//		are antennas[bucketStarts[c]] to antennas[bucketStarts[c + 1] - 1].
+//------------------------------------------------------------------------------
+struct AntennaMap
+{
+	size_t                    height;
+	size_t                    width;
+	std::vector<GridPosition> antennas;
+	std::vector<size_t>       bucketStarts;
+};
+
+
+
+
+
 //==============================================================================
 //		Solve - Returns the solution to the problem for the given input.
 //------------------------------------------------------------------------------
@@ -42,6 +63,35 @@ int Solve(std::vector<std::string> input, bool debug = false);
 
 
 
+
+
+//==============================================================================
+//		ParseAntennas - Converts the input into an antenna map.
+//------------------------------------------------------------------------------
+AntennaMap ParseAntennas(const std::vector<std::string>& input);
+
+
+
+
+
+//==============================================================================
+//		CountAntinodes - Returns the number of unique antinode positions,
+//		processing the frequencies in parallel.
+//------------------------------------------------------------------------------
+size_t CountAntinodes(const AntennaMap& map, unsigned threadCount, bool debug);
+
+
+
+
+
+//==============================================================================
+//		FindAntinodes - Adds the linear index of every antinode produced by the
+//		given frequency's antennas to the set.
+//------------------------------------------------------------------------------
+void FindAntinodes(const AntennaMap& map, unsigned char frequency, std::unordered_set<uint64_t>& antinodes);
+
+
+
 } // Solution
 
 